@@ -15,12 +15,33 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <barrier>
 #include <bit>
+#include <cerrno>
+#include <cmath>
 #include <concepts>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <stdfloat>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <sched.h>
+#include <sys/utsname.h>
+
+#include "perf.h"
 
 #if USE_STD_SIMD == 0
 namespace stdx
@@ -193,29 +214,1542 @@ std::ostream& operator<<(std::ostream& s, stdx::simd_mask<T, Abi> const& v)
 }
 #endif
 
-template <vec_builtin V>
-  std::ostream& operator<<(std::ostream& s, V v)
-  { return s << simd<value_type_t<V>, width_of<V>>(v); }
+template <vec_builtin V>
+  std::ostream& operator<<(std::ostream& s, V v)
+  { return s << simd<value_type_t<V>, width_of<V>>(v); }
+
+/**
+ * The most performance counters that can be requested via BENCH_COUNTERS.
+ */
+inline constexpr int max_counters = 8;
+
+/**
+ * The numbers of independent chains time_throughput measures if compiled with
+ * -DBENCH_ILP_SWEEP.
+ */
+inline constexpr std::array<int, 10> ilp_chain_counts = {1, 2, 3, 4, 6, 8, 12, 16, 24, 32};
+
+/**
+ * Runtime configuration of the harness, read once from the environment:
+ *
+ * BENCH_OUTPUT  File to write machine-readable results to ("-" for stdout).
+ * BENCH_FORMAT  "jsonl" or "csv". Defaults to csv if BENCH_OUTPUT ends in
+ *               ".csv" and to jsonl otherwise.
+ *
+ * If the machine-readable results go to stdout, the ANSI table is not printed.
+ *
+ * BENCH_ESTIMATOR   "median" (default) or "min": the statistic over all batches
+ *                   that is reported as cycles/call.
+ * BENCH_CI_WIDTH    Stop timing once the 95% confidence interval of the median
+ *                   is narrower than this fraction of the median (default 0.02).
+ * BENCH_MAX_BATCHES Upper limit on the number of batches per timing run
+ *                   (default: 10 × the Retries template argument).
+ * BENCH_BATCH_TIME  Target duration of one batch in microseconds (default
+ *                   1000). The number of iterations per batch is calibrated at
+ *                   the start of every timing run. 0 uses the Iterations
+ *                   template argument instead.
+ * BENCH_TIME_BUDGET Milliseconds per table cell (default 0: unlimited). Once a
+ *                   row has used up its budget, its timing runs stop after 3
+ *                   batches, regardless of Retries and BENCH_CI_WIDTH.
+ * BENCH_OVERHEAD    What to subtract from every batch (see TimingOverhead):
+ *                   "timer" (default) the cost of reading the cycle counter,
+ *                   "loop" additionally the loop overhead per iteration, "0"
+ *                   nothing.
+ *
+ * BENCH_CLOCK  The cycle counter used for timing (see CycleClock): "tsc",
+ *              "perf", or "auto" (default).
+ *
+ * BENCH_COUNTERS  Comma-separated list of hardware performance counters to
+ *                 report per call, e.g. "instructions,uops_issued=r010e". See
+ *                 parse_perf_event for the event syntax; "name=" sets the
+ *                 column name.
+ *
+ * BENCH_FILTER  Only measure the matching rows, e.g. "type=float;width=8|16".
+ *               Terms are separated by ';' and all of them must match. Each term
+ *               is "key=pattern[|pattern...]" with key one of type, width, abi,
+ *               flags and shell wildcard patterns (fnmatch). The reference row
+ *               of a table is always measured.
+ *
+ * BENCH_CPU    The CPU to pin the process to, or "none". By default the process
+ *              stays on the CPU it starts on.
+ * BENCH_MLOCK  If "1", lock all memory of the process (mlockall) and prefault
+ *              the stack, so that no page faults occur while timing.
+ * BENCH_HUGEPAGES  If "1", back large buffers (see alloc_buffer) with
+ *                  transparent huge pages.
+ *
+ * BENCH_COOLDOWN   Milliseconds to sleep before each row, so that frequency
+ *                  throttling caused by the previous row can wear off
+ *                  (default 0).
+ * BENCH_REMEASURE  How often a row whose effective frequency dropped below that
+ *                  of the fastest row so far is measured again (default 0).
+ *
+ * BENCH_ENERGY  If "1", report the energy per call from the RAPL counters in
+ *               /sys/class/powercap (see EnergyMeter).
+ *
+ * BENCH_PROFILE  Profile mode: after measuring a row that matches BENCH_FILTER
+ *                (reference rows only if they match themselves), run it again
+ *                for this many seconds, for a sampling profiler.
+ * BENCH_PROFILE_CTL  "<ctl-fifo>[,<ack-fifo>]": in profile mode, write
+ *                    "enable\n" to ctl-fifo before each timing loop and
+ *                    "disable\n" after it, and wait for "ack\n" on ack-fifo.
+ *                    This is the protocol of `perf record -D -1
+ *                    --control=fifo:<ctl-fifo>,<ack-fifo>` (see profile.sh), so
+ *                    the setup code of the benchmarks is not sampled.
+ *
+ * BENCH_THREADS  Scaling mode: after measuring a row that matches BENCH_FILTER,
+ *                run it again on this many threads at once, each pinned to its
+ *                own physical core, e.g. "1,2,4" or "all" (1 up to the number of
+ *                cores). See measure_scaling.
+ * BENCH_SIBLING  In scaling mode, additionally measure with the SMT siblings of
+ *                these cores busy: "same" runs the same kernel on them, "fma" a
+ *                loop of independent FMAs (default "none").
+ */
+struct BenchOptions
+{
+  enum class Format { none, jsonl, csv };
+
+  enum class Estimator { median, min };
+
+  enum class Clock { automatic, tsc, perf };
+
+  Format format = Format::none;
+  std::FILE* output = nullptr;
+  bool table = true;
+  Estimator estimator = Estimator::median;
+  double ci_width = 0.02;
+  int max_batches = 0;
+  long batch_time_ns = 1'000'000;
+  long time_budget_ns = 0;
+  enum class Overhead { none, timer, loop } overhead = Overhead::timer;
+  Clock clock = Clock::automatic;
+  // column name and event of each requested performance counter
+  std::vector<std::pair<std::string, std::string>> counters;
+  // key and '|'-separated patterns of each BENCH_FILTER term
+  std::vector<std::pair<std::string, std::string>> filter;
+  bool pin = true;
+  // -1: the CPU the process starts on
+  int cpu = -1;
+  bool mlock = false;
+  bool hugepages = false;
+  int cooldown_ms = 0;
+  int remeasure = 0;
+  bool energy = false;
+  long profile_ns = 0;
+  // BENCH_PROFILE_CTL FIFOs or -1
+  int profile_ctl = -1;
+  int profile_ack = -1;
+  // BENCH_THREADS thread counts; 0: all cores
+  std::vector<int> threads;
+  enum class Sibling { none, same, fma } sibling = Sibling::none;
+
+  BenchOptions()
+  {
+    if (const char* ms = std::getenv("BENCH_COOLDOWN"))
+      cooldown_ms = std::atoi(ms);
+    if (const char* n = std::getenv("BENCH_REMEASURE"))
+      remeasure = std::atoi(n);
+    if (const char* str = std::getenv("BENCH_CPU"))
+      {
+        char* end = nullptr;
+        if (std::string_view(str) == "none")
+          pin = false;
+        else if (cpu = std::strtol(str, &end, 10); *str == '\0' or *end != '\0' or cpu < 0)
+          {
+            std::cerr << "BENCH_CPU must be a CPU number or 'none'\n";
+            std::exit(1);
+          }
+      }
+    if (const char* str = std::getenv("BENCH_MLOCK"))
+      mlock = std::string_view(str) == "1";
+    if (const char* str = std::getenv("BENCH_HUGEPAGES"))
+      hugepages = std::string_view(str) == "1";
+    if (const char* str = std::getenv("BENCH_ENERGY"))
+      energy = std::string_view(str) == "1";
+    if (const char* seconds = std::getenv("BENCH_PROFILE"))
+      profile_ns = long(std::atof(seconds) * 1e9);
+    if (const char* fifos = std::getenv("BENCH_PROFILE_CTL"); fifos and profile_ns > 0)
+      {
+        const std::string_view str = fifos;
+        const std::string ctl(str.substr(0, str.find(',')));
+        if ((profile_ctl = open(ctl.c_str(), O_WRONLY | O_CLOEXEC)) < 0)
+          {
+            std::cerr << "cannot open BENCH_PROFILE_CTL '" << ctl << "': "
+                      << std::strerror(errno) << '\n';
+            std::exit(1);
+          }
+        if (const std::size_t comma = str.find(','); comma != str.npos)
+          {
+            const std::string ack(str.substr(comma + 1));
+            if ((profile_ack = open(ack.c_str(), O_RDONLY | O_CLOEXEC)) < 0)
+              {
+                std::cerr << "cannot open BENCH_PROFILE_CTL '" << ack << "': "
+                          << std::strerror(errno) << '\n';
+                std::exit(1);
+              }
+          }
+      }
+    if (const char* list = std::getenv("BENCH_THREADS"))
+      {
+        std::string_view rest = list;
+        if (rest == "all")
+          threads.push_back(0);
+        else
+          while (not rest.empty())
+            {
+              const std::string item(rest.substr(0, rest.find(',')));
+              rest.remove_prefix(std::min(rest.size(), item.size() + 1));
+              char* end = nullptr;
+              const long n = std::strtol(item.c_str(), &end, 10);
+              if (item.empty() or *end != '\0' or n < 1)
+                {
+                  std::cerr << "BENCH_THREADS must be 'all' or a comma-separated list of "
+                               "thread counts\n";
+                  std::exit(1);
+                }
+              threads.push_back(int(n));
+            }
+      }
+    if (const char* str = std::getenv("BENCH_SIBLING"))
+      {
+        if (std::string_view(str) == "same")
+          sibling = Sibling::same;
+        else if (std::string_view(str) == "fma")
+          sibling = Sibling::fma;
+        else if (std::string_view(str) != "none")
+          {
+            std::cerr << "BENCH_SIBLING must be one of: none, same, fma\n";
+            std::exit(1);
+          }
+      }
+    if (const char* terms = std::getenv("BENCH_FILTER"))
+      {
+        std::string_view rest = terms;
+        while (not rest.empty())
+          {
+            const std::string_view term = rest.substr(0, rest.find(';'));
+            rest.remove_prefix(std::min(rest.size(), term.size() + 1));
+            if (term.empty())
+              continue;
+            const std::size_t eq = term.find('=');
+            const std::string_view key = term.substr(0, eq);
+            if (eq == term.npos
+                  or (key != "type" and key != "width" and key != "abi" and key != "flags"))
+              {
+                std::cerr << "BENCH_FILTER: expected type=, width=, abi=, or flags= instead of '"
+                          << term << "'\n";
+                std::exit(1);
+              }
+            filter.emplace_back(key, term.substr(eq + 1));
+          }
+      }
+    if (const char* list = std::getenv("BENCH_COUNTERS"))
+      {
+        std::string_view rest = list;
+        while (not rest.empty())
+          {
+            const std::string_view item = rest.substr(0, rest.find(','));
+            rest.remove_prefix(std::min(rest.size(), item.size() + 1));
+            if (item.empty())
+              continue;
+            const std::size_t eq = item.find('=');
+            if (eq == item.npos)
+              counters.emplace_back(item, item);
+            else
+              counters.emplace_back(item.substr(0, eq), item.substr(eq + 1));
+            std::uint32_t type;
+            std::uint64_t config;
+            if (not parse_perf_event(counters.back().second, type, config))
+              {
+                std::cerr << "BENCH_COUNTERS: unknown event '" << counters.back().second << "'\n";
+                std::exit(1);
+              }
+          }
+        if (counters.size() > max_counters)
+          {
+            std::cerr << "BENCH_COUNTERS: at most " << max_counters
+                      << " counters are supported\n";
+            std::exit(1);
+          }
+      }
+    if (const char* clk = std::getenv("BENCH_CLOCK"))
+      {
+        if (std::string_view(clk) == "tsc")
+          clock = Clock::tsc;
+        else if (std::string_view(clk) == "perf")
+          clock = Clock::perf;
+        else if (std::string_view(clk) != "auto")
+          {
+            std::cerr << "BENCH_CLOCK must be one of: auto, tsc, perf\n";
+            std::exit(1);
+          }
+      }
+    if (const char* est = std::getenv("BENCH_ESTIMATOR"))
+      {
+        if (std::string_view(est) == "min")
+          estimator = Estimator::min;
+        else if (std::string_view(est) != "median")
+          {
+            std::cerr << "BENCH_ESTIMATOR must be one of: median, min\n";
+            std::exit(1);
+          }
+      }
+    if (const char* width = std::getenv("BENCH_CI_WIDTH"))
+      ci_width = std::atof(width);
+    if (const char* max = std::getenv("BENCH_MAX_BATCHES"))
+      max_batches = std::atoi(max);
+    if (const char* us = std::getenv("BENCH_BATCH_TIME"))
+      batch_time_ns = std::atol(us) * 1000;
+    if (const char* ms = std::getenv("BENCH_TIME_BUDGET"))
+      time_budget_ns = std::atol(ms) * 1'000'000;
+    if (const char* str = std::getenv("BENCH_OVERHEAD"))
+      {
+        const std::string_view mode = str;
+        if (mode == "0" or mode == "none")
+          overhead = Overhead::none;
+        else if (mode == "timer")
+          overhead = Overhead::timer;
+        else if (mode == "loop")
+          overhead = Overhead::loop;
+        else
+          {
+            std::cerr << "BENCH_OVERHEAD must be one of: timer, loop, 0\n";
+            std::exit(1);
+          }
+      }
+
+    const char* path = std::getenv("BENCH_OUTPUT");
+    const char* fmt = std::getenv("BENCH_FORMAT");
+    if (path == nullptr and fmt == nullptr)
+      return;
+    const std::string_view f = fmt ? fmt : "";
+    if (f == "csv" or (f.empty() and std::string_view(path).ends_with(".csv")))
+      format = Format::csv;
+    else if (f.empty() or f == "jsonl" or f == "json")
+      format = Format::jsonl;
+    else
+      {
+        std::cerr << "BENCH_FORMAT must be one of: jsonl, csv\n";
+        std::exit(1);
+      }
+    if (path == nullptr or std::string_view(path) == "-")
+      {
+        output = stdout;
+        table = false;
+      }
+    else if ((output = std::fopen(path, "w")) == nullptr)
+      {
+        std::cerr << "cannot open BENCH_OUTPUT '" << path << "': "
+                  << std::strerror(errno) << '\n';
+        std::exit(1);
+      }
+  }
+};
+
+[[gnu::noinline]] inline const BenchOptions&
+bench_options()
+{
+  static const BenchOptions opts;
+  return opts;
+}
+
+/**
+ * Prepares the process for timing (CPU pinning, memory locking) and records the
+ * environment the results were obtained in: CPU, microcode, frequency scaling,
+ * SMT, isolated CPUs, kernel and compiler. Setups that are known to produce
+ * noisy numbers are listed in warnings.
+ */
+class RunEnvironment
+{
+  static std::string
+  read_line(const std::string& path)
+  {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+  }
+
+  [[gnu::noinline]] static void
+  prefault_stack()
+  {
+    volatile char buf[1 << 18];
+    for (std::size_t i = 0; i < sizeof(buf); i += 4096)
+      buf[i] = 0;
+  }
+
+public:
+  // the fingerprint as key-value pairs, in the order they are reported
+  std::vector<std::pair<std::string, std::string>> fields;
+  std::vector<std::string> warnings;
+
+  RunEnvironment()
+  {
+    const BenchOptions& opts = bench_options();
+    auto add = [&](const char* key, std::string value) { fields.emplace_back(key, value); };
+
+    int cpu = opts.cpu;
+    if (opts.pin)
+      {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (cpu < 0 and sched_getaffinity(0, sizeof(set), &set) == 0 and CPU_COUNT(&set) == 1)
+          for (int i = 0; i < CPU_SETSIZE; ++i)
+            if (CPU_ISSET(i, &set))
+              cpu = i;
+        if (cpu < 0)
+          cpu = sched_getcpu();
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+          {
+            warnings.push_back("cannot pin to CPU " + std::to_string(cpu) + ": "
+                                 + std::strerror(errno));
+            cpu = -1;
+          }
+      }
+    else
+      warnings.push_back("not pinned to a CPU (BENCH_CPU=none)");
+    add("cpu", cpu < 0 ? "none" : std::to_string(cpu));
+
+    bool locked = false;
+    if (opts.mlock)
+      {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+          {
+            prefault_stack();
+            locked = true;
+          }
+        else
+          warnings.push_back(std::string("mlockall failed: ") + std::strerror(errno));
+      }
+    add("mlock", locked ? "on" : "off");
+    add("hugepages", opts.hugepages ? "on" : "off");
+
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string model, microcode;
+    for (std::string line; std::getline(cpuinfo, line) and (model.empty() or microcode.empty());)
+      {
+        const std::size_t colon = line.find(':');
+        if (colon == line.npos or colon + 2 > line.size())
+          continue;
+        if (model.empty() and line.starts_with("model name"))
+          model = line.substr(colon + 2);
+        else if (microcode.empty() and line.starts_with("microcode"))
+          microcode = line.substr(colon + 2);
+      }
+    add("cpu_model", model);
+    add("microcode", microcode);
+
+    const std::string sys = "/sys/devices/system/cpu/";
+    const std::string governor
+      = read_line(sys + "cpu" + std::to_string(std::max(cpu, 0)) + "/cpufreq/scaling_governor");
+    add("governor", governor);
+    if (not governor.empty() and governor != "performance")
+      warnings.push_back("scaling governor is '" + governor + "' instead of 'performance'");
+
+    std::string turbo;
+    if (const std::string no_turbo = read_line(sys + "intel_pstate/no_turbo"); not no_turbo.empty())
+      turbo = no_turbo == "1" ? "off" : "on";
+    else if (const std::string boost = read_line(sys + "cpufreq/boost"); not boost.empty())
+      turbo = boost == "1" ? "on" : "off";
+    add("turbo", turbo);
+    if (turbo == "on")
+      warnings.push_back("turbo/boost is enabled (see benchmark-mode.sh)");
+
+    const std::string smt = read_line(sys + "smt/active");
+    add("smt", smt == "1" ? "on" : smt == "0" ? "off" : "");
+    if (cpu >= 0)
+      {
+        const std::string siblings = read_line(sys + "cpu" + std::to_string(cpu)
+                                                 + "/topology/thread_siblings_list");
+        if (siblings.find_first_of(",-") != siblings.npos)
+          warnings.push_back("the SMT siblings of CPU " + std::to_string(cpu) + " (" + siblings
+                               + ") are online");
+      }
+    add("isolated", read_line(sys + "isolated"));
+
+    if (sched_getscheduler(0) != SCHED_FIFO)
+      warnings.push_back("not running with realtime priority (chrt --fifo)");
+
+    utsname uts;
+    if (uname(&uts) == 0)
+      {
+        add("host", uts.nodename);
+        add("kernel", std::string(uts.release) + ' ' + uts.machine);
+      }
+#ifdef __clang__
+    add("compiler", __VERSION__);
+#else
+    add("compiler", "GCC " __VERSION__);
+#endif
+#ifdef BENCH_CXXFLAGS
+    add("cxxflags", BENCH_CXXFLAGS);
+#else
+    add("cxxflags", "");
+#endif
+  }
+};
+
+[[gnu::noinline]] inline const RunEnvironment&
+run_environment()
+{
+  static const RunEnvironment env;
+  return env;
+}
+
+/**
+ * A zero-filled buffer of at least \p bytes, aligned to 2 MiB (free it with
+ * free_buffer). It is backed by transparent huge pages if BENCH_HUGEPAGES=1 and by 4 KiB
+ * pages otherwise. All pages are touched, so that no page faults occur while
+ * timing.
+ */
+[[gnu::noinline]] inline char*
+alloc_buffer(std::size_t bytes)
+{
+  constexpr std::size_t huge = std::size_t(2) << 20;
+  bytes = (bytes + huge - 1) / huge * huge;
+  void* p = mmap(nullptr, bytes + huge, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1, 0);
+  if (p == MAP_FAILED)
+    {
+      std::cerr << "cannot allocate " << bytes << " bytes: " << std::strerror(errno) << '\n';
+      std::exit(1);
+    }
+  char* buf = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(p) + huge - 1)
+                                        & ~(huge - 1));
+  // unmap the unaligned head and tail
+  if (const std::size_t head = buf - static_cast<char*>(p); head > 0)
+    munmap(p, head);
+  if (const std::size_t tail = huge - (buf - static_cast<char*>(p)); tail > 0)
+    munmap(buf + bytes, tail);
+  if (madvise(buf, bytes, bench_options().hugepages ? MADV_HUGEPAGE : MADV_NOHUGEPAGE) != 0
+        and bench_options().hugepages)
+    {
+      static std::atomic<bool> warned = false;
+      if (not warned.exchange(true))
+        std::cerr << "madvise(MADV_HUGEPAGE) failed: " << std::strerror(errno) << '\n';
+    }
+  std::memset(buf, 0, bytes);
+  return buf;
+}
+
+inline void
+free_buffer(char* buf, std::size_t bytes)
+{
+  constexpr std::size_t huge = std::size_t(2) << 20;
+  munmap(buf, (bytes + huge - 1) / huge * huge);
+}
+
+/**
+ * The calling thread's buffer of at least \p bytes (see alloc_buffer), so that
+ * the threads of the scaling mode (see measure_scaling) do not write to the same
+ * cache lines. It is zero-filled whenever it grows, which loses its contents,
+ * and freed when the thread exits.
+ */
+[[gnu::noinline]] inline char*
+thread_buffer(std::size_t bytes)
+{
+  struct Buffer
+  {
+    char* ptr = nullptr;
+    std::size_t size = 0;
+
+    ~Buffer()
+    {
+      if (ptr)
+        free_buffer(ptr, size);
+    }
+  };
+  static thread_local Buffer buf;
+  if (buf.size < bytes)
+    {
+      if (buf.ptr)
+        free_buffer(buf.ptr, buf.size);
+      buf.ptr = alloc_buffer(bytes);
+      buf.size = bytes;
+    }
+  return buf.ptr;
+}
+
+/**
+ * The cycle counter read by all timing functions.
+ *
+ * The TSC counts reference cycles at a constant rate, which differs from the
+ * core clock whenever the core runs at a different frequency (turbo, AVX
+ * license, power saving). The perf backend counts actual core cycles of the
+ * calling thread via perf_event_open (PERF_COUNT_HW_CPU_CYCLES) and reads them
+ * with rdpmc if the kernel permits it, otherwise with a read system call.
+ * BENCH_CLOCK=auto uses perf if the PMU is accessible and falls back to the
+ * TSC otherwise.
+ */
+class CycleClock
+{
+  PerfEvent counter;
+
+public:
+  CycleClock()
+  {
+    const BenchOptions::Clock which = bench_options().clock;
+    if (which == BenchOptions::Clock::tsc)
+      return;
+    counter = PerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, true);
+    if (not counter and which == BenchOptions::Clock::perf)
+      std::cerr << "BENCH_CLOCK=perf: perf_event_open failed (" << std::strerror(errno)
+                << "), falling back to the TSC\n";
+  }
+
+  [[gnu::always_inline]] unsigned long
+  now() const
+  {
+    if (counter)
+      return read_counter();
+    unsigned int tmp;
+    return __rdtscp(&tmp);
+  }
+
+  [[gnu::noinline]] unsigned long
+  read_counter() const
+  {
+    _mm_lfence();
+    return counter.read();
+  }
+
+  const char*
+  name() const
+  {
+    if (not counter)
+      return "tsc";
+    else if (counter.has_rdpmc())
+      return "perf-rdpmc";
+    else
+      return "perf-read";
+  }
+};
+
+/**
+ * The CycleClock of the calling thread.
+ */
+[[gnu::noinline]] inline const CycleClock&
+cycle_clock()
+{
+  static thread_local const CycleClock clock;
+  return clock;
+}
+
+/**
+ * The hardware performance counters requested via BENCH_COUNTERS, counted for
+ * the calling thread in one group. If the PMU is not accessible (e.g. in a VM),
+ * the counters are reported as unavailable.
+ */
+class PerfCounters
+{
+  PerfGroup group;
+  int requested = 0;
+
+public:
+  PerfCounters()
+  {
+    const auto& counters = bench_options().counters;
+    requested = counters.size();
+    for (const auto& [name, event] : counters)
+      {
+        std::uint32_t type = 0;
+        std::uint64_t config = 0;
+        parse_perf_event(event, type, config);
+        if (not group.add(type, config))
+          {
+            static bool warned = false;
+            if (not std::exchange(warned, true))
+              std::cerr << "BENCH_COUNTERS: cannot count '" << event << "' ("
+                        << std::strerror(errno) << "), reporting counters as unavailable\n";
+            group = PerfGroup();
+            break;
+          }
+      }
+  }
+
+  int
+  size() const
+  { return requested; }
+
+  /**
+   * Reads all counters into \p values. Returns false if they are unavailable.
+   */
+  bool
+  read(std::uint64_t* values) const
+  { return group.read(values); }
+};
+
+/**
+ * The PerfCounters of the calling thread.
+ */
+[[gnu::noinline]] inline const PerfCounters&
+perf_counters()
+{
+  static thread_local const PerfCounters counters;
+  return counters;
+}
+
+/**
+ * Effective core frequency of each benchmark row, from the APERF and MPERF
+ * MSRs. MPERF counts at the TSC rate and APERF at the actual core clock while
+ * the core is not halted, thus TSC frequency × ΔAPERF/ΔMPERF is the average
+ * frequency the row ran at. The MSRs are read via the perf msr PMU if it
+ * publishes them and otherwise via /dev/cpu/<n>/msr (requires the msr module
+ * and permissions).
+ *
+ * AVX-512 (and on older cores AVX2) license throttling lowers the frequency for
+ * a while after the heavy instructions retire, which penalizes the rows
+ * measured next. A row is flagged as throttled if its frequency is more than
+ * 3% below the fastest row so far.
+ */
+class FrequencyMonitor
+{
+  PerfGroup group;
+  int msr_fd = -1;
+  double tsc_ghz = 0;
+  std::uint64_t start_aperf = 0;
+  std::uint64_t start_mperf = 0;
+  double baseline = 0;
+
+  bool
+  read(std::uint64_t& aperf, std::uint64_t& mperf) const
+  {
+    if (group.size() == 2)
+      {
+        std::uint64_t values[2];
+        if (not group.read(values))
+          return false;
+        aperf = values[0];
+        mperf = values[1];
+        return true;
+      }
+    return pread(msr_fd, &aperf, 8, 0xe8) == 8 and pread(msr_fd, &mperf, 8, 0xe7) == 8;
+  }
+
+public:
+  static constexpr double tolerance = 0.03;
+
+  // of the last row: the effective frequency (NaN if unknown) and whether it
+  // was lower than the baseline
+  double ghz = std::numeric_limits<double>::quiet_NaN();
+  bool throttled = false;
+
+  FrequencyMonitor()
+  {
+    std::uint32_t type;
+    std::uint64_t aperf, mperf;
+    if (parse_pmu_event("msr", "aperf", type, aperf) and group.add(type, aperf, false))
+      if (not parse_pmu_event("msr", "mperf", type, mperf) or not group.add(type, mperf, false))
+        group = PerfGroup();
+    if (group.size() != 2)
+      {
+        group = PerfGroup();
+        const std::string dev = "/dev/cpu/" + std::to_string(sched_getcpu()) + "/msr";
+        msr_fd = open(dev.c_str(), O_RDONLY | O_CLOEXEC);
+        if (msr_fd >= 0 and not read(aperf, mperf))
+          {
+            close(msr_fd);
+            msr_fd = -1;
+          }
+      }
+    // calibrate the TSC against CLOCK_MONOTONIC for 20 ms
+    timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    const std::uint64_t tsc0 = __rdtsc();
+    do
+      clock_gettime(CLOCK_MONOTONIC, &t1);
+    while ((t1.tv_sec - t0.tv_sec) * 1'000'000'000l + (t1.tv_nsec - t0.tv_nsec) < 20'000'000);
+    const std::uint64_t tsc1 = __rdtsc();
+    tsc_ghz = double(tsc1 - tsc0)
+                / ((t1.tv_sec - t0.tv_sec) * 1'000'000'000l + (t1.tv_nsec - t0.tv_nsec));
+  }
+
+  ~FrequencyMonitor()
+  {
+    if (msr_fd >= 0)
+      close(msr_fd);
+  }
+
+  explicit
+  operator bool() const
+  { return group.size() == 2 or msr_fd >= 0; }
+
+  const char*
+  name() const
+  { return group.size() == 2 ? "msr-pmu" : msr_fd >= 0 ? "msr-dev" : "none"; }
+
+  double
+  tsc_frequency() const
+  { return tsc_ghz; }
+
+  /**
+   * Sleeps for BENCH_COOLDOWN and starts measuring a row.
+   */
+  [[gnu::noinline]] void
+  start()
+  {
+    if (const int ms = bench_options().cooldown_ms; ms > 0)
+      usleep(ms * 1000);
+    if (not *this or not read(start_aperf, start_mperf))
+      start_aperf = start_mperf = 0;
+  }
+
+  /**
+   * Ends measuring a row. Returns whether it should be measured again.
+   */
+  [[gnu::noinline]] bool
+  stop(int attempt)
+  {
+    std::uint64_t aperf, mperf;
+    ghz = std::numeric_limits<double>::quiet_NaN();
+    throttled = false;
+    if (start_mperf == 0 or not read(aperf, mperf) or mperf <= start_mperf)
+      return false;
+    ghz = tsc_ghz * double(aperf - start_aperf) / double(mperf - start_mperf);
+    throttled = ghz < baseline * (1 - tolerance);
+    baseline = std::max(baseline, ghz);
+    if (throttled and attempt < bench_options().remeasure)
+      {
+        // give the core time to leave the lower frequency license
+        usleep(std::max(bench_options().cooldown_ms, 10) * 1000);
+        return true;
+      }
+    return false;
+  }
+};
+
+/**
+ * The FrequencyMonitor of the calling thread.
+ */
+[[gnu::noinline]] inline FrequencyMonitor&
+frequency_monitor()
+{
+  static thread_local FrequencyMonitor monitor;
+  return monitor;
+}
+
+/**
+ * Energy consumed by the CPU package the process runs on and by its cores, from
+ * the RAPL counters in /sys/class/powercap (BENCH_ENERGY=1). The counters
+ * cover the whole package, including other cores and the uncore, and update
+ * about every millisecond, so only runs of many milliseconds on an otherwise
+ * idle package give meaningful numbers. Since Linux 5.10 energy_uj is readable
+ * by root only.
+ */
+class EnergyMeter
+{
+  struct Zone
+  {
+    int fd = -1;
+    double max_uj = 0;
+  };
+
+  Zone package, core;
+  std::string zone_name = "none";
+
+  static std::string
+  read_line(const std::string& path)
+  {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+  }
+
+  static Zone
+  open_zone(const std::string& dir)
+  {
+    Zone z;
+    z.fd = open((dir + "/energy_uj").c_str(), O_RDONLY | O_CLOEXEC);
+    z.max_uj = std::atof(read_line(dir + "/max_energy_range_uj").c_str());
+    double uj;
+    if (z.fd >= 0 and not read(z, uj))
+      {
+        close(z.fd);
+        z.fd = -1;
+      }
+    return z;
+  }
+
+  static bool
+  read(const Zone& z, double& uj)
+  {
+    char buf[32];
+    const ssize_t n = pread(z.fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0)
+      return false;
+    buf[n] = '\0';
+    uj = std::atof(buf);
+    return true;
+  }
+
+public:
+  EnergyMeter()
+  {
+    if (not bench_options().energy)
+      return;
+    const std::string want
+      = "package-" + read_line("/sys/devices/system/cpu/cpu" + std::to_string(sched_getcpu())
+                                 + "/topology/physical_package_id");
+    for (int p = 0; p < 16 and package.fd < 0; ++p)
+      {
+        const std::string dir = "/sys/class/powercap/intel-rapl:" + std::to_string(p);
+        if (read_line(dir + "/name") != want)
+          continue;
+        package = open_zone(dir);
+        if (package.fd < 0)
+          {
+            std::cerr << "BENCH_ENERGY: cannot read " << dir << "/energy_uj (root only?)\n";
+            return;
+          }
+        zone_name = dir.substr(dir.rfind('/') + 1);
+        for (int c = 0; c < 8 and core.fd < 0; ++c)
+          {
+            const std::string sub = dir + '/' + zone_name + ':' + std::to_string(c);
+            if (read_line(sub + "/name") == "core")
+              core = open_zone(sub);
+          }
+      }
+    if (package.fd < 0)
+      std::cerr << "BENCH_ENERGY: no RAPL " << want << " in /sys/class/powercap\n";
+  }
+
+  ~EnergyMeter()
+  {
+    if (package.fd >= 0)
+      close(package.fd);
+    if (core.fd >= 0)
+      close(core.fd);
+  }
+
+  explicit
+  operator bool() const
+  { return package.fd >= 0; }
+
+  const char*
+  name() const
+  { return zone_name.c_str(); }
+
+  /**
+   * The current package and core counters in µJ (core is NaN if unavailable).
+   */
+  [[gnu::noinline]] void
+  read(double& package_uj, double& core_uj) const
+  {
+    core_uj = std::numeric_limits<double>::quiet_NaN();
+    if (not read(package, package_uj))
+      package_uj = std::numeric_limits<double>::quiet_NaN();
+    if (core.fd >= 0 and not read(core, core_uj))
+      core_uj = std::numeric_limits<double>::quiet_NaN();
+  }
+
+  /**
+   * The energy in nJ between two readings of the package (or core) counter,
+   * which wraps around at max_energy_range_uj.
+   */
+  double
+  nanojoules(double start_uj, double end_uj, bool of_core = false) const
+  {
+    const double range = (of_core ? core : package).max_uj;
+    return 1000 * (end_uj >= start_uj ? end_uj - start_uj : end_uj + range - start_uj);
+  }
+};
+
+/**
+ * The EnergyMeter of the calling thread.
+ */
+[[gnu::noinline]] inline const EnergyMeter&
+energy_meter()
+{
+  static thread_local const EnergyMeter meter;
+  return meter;
+}
+
+/**
+ * The CPUs for the scaling mode (BENCH_THREADS): one CPU per physical core,
+ * starting with the core of the calling thread, and the SMT sibling of each of
+ * these CPUs (-1 if the core runs only one thread). Read from the
+ * thread_siblings_list files in /sys/devices/system/cpu/cpu<N>/topology.
+ */
+class CoreTopology
+{
+  static std::vector<int>
+  siblings_of(int cpu)
+  {
+    std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu)
+                         + "/topology/thread_siblings_list");
+    std::vector<int> cpus;
+    std::string item;
+    // e.g. "0,64" or "0-1"
+    while (std::getline(file, item, ','))
+      {
+        const int first = std::atoi(item.c_str());
+        const std::size_t dash = item.find('-');
+        const int last = dash == item.npos ? first : std::atoi(item.c_str() + dash + 1);
+        for (int c = first; c <= last; ++c)
+          cpus.push_back(c);
+      }
+    return cpus;
+  }
+
+public:
+  struct Core
+  {
+    int cpu;
+    int sibling;
+  };
+
+  std::vector<Core> cores;
+
+  CoreTopology()
+  {
+    const int self = sched_getcpu();
+    const long configured = sysconf(_SC_NPROCESSORS_CONF);
+    for (int cpu = 0; cpu < configured; ++cpu)
+      {
+        const std::vector<int> siblings = siblings_of(cpu);
+        // offline CPUs have no topology; every core is listed by its first CPU
+        if (siblings.empty() or siblings.front() != cpu)
+          continue;
+        if (std::find(siblings.begin(), siblings.end(), self) != siblings.end())
+          {
+            const auto twin = std::find_if(siblings.begin(), siblings.end(),
+                                           [&](int c) { return c != self; });
+            cores.insert(cores.begin(), {self, twin == siblings.end() ? -1 : *twin});
+          }
+        else
+          cores.push_back({cpu, siblings.size() > 1 ? siblings[1] : -1});
+      }
+    if (cores.empty())
+      cores.push_back({self, -1});
+  }
+};
+
+[[gnu::noinline]] inline const CoreTopology&
+core_topology()
+{
+  static const CoreTopology topology;
+  return topology;
+}
+
+/**
+ * std::isnan / std::isfinite on the bit pattern. -ffast-math (the fastmath
+ * variant) lets GCC fold the std:: functions to constants, which would leak NaN
+ * sentinels into the table and the result files.
+ */
+inline bool
+is_nan(double x)
+{ return (std::bit_cast<std::uint64_t>(x) & 0x7fff'ffff'ffff'ffff) > 0x7ff0'0000'0000'0000; }
+
+inline bool
+is_finite(double x)
+{ return (std::bit_cast<std::uint64_t>(x) & 0x7ff0'0000'0000'0000) != 0x7ff0'0000'0000'0000; }
+
+/**
+ * Distribution of the per-batch cycles/call of one timing run.
+ *
+ * Scaling and differences are applied to all statistics, so that e.g.
+ * `0.25 * time_mean(...)` or the difference of a real and a fake run keep
+ * their statistics. The confidence interval of a difference combines the
+ * half-widths of both operands in quadrature.
+ */
+struct Measurement
+{
+  // the estimate reported as cycles/call (see BENCH_ESTIMATOR)
+  double value = 0;
+  double min = 0;
+  double median = 0;
+  double p90 = 0;
+  // median absolute deviation from the median
+  double mad = 0;
+  // 95% confidence interval of the median
+  double ci_low = 0;
+  double ci_high = 0;
+  int samples = 0;
+  // timer and loop overhead per call that was subtracted (see TimingOverhead)
+  double overhead = 0;
+  // the median without that subtraction
+  double raw_median = 0;
+  // intercept and coefficient of determination of a chain-length fit (see
+  // time_latency_fit), NaN otherwise
+  double fit_intercept = std::numeric_limits<double>::quiet_NaN();
+  double fit_r2 = std::numeric_limits<double>::quiet_NaN();
+  // cycles/call for each of ilp_chain_counts (see time_throughput), NaN
+  // otherwise
+  std::array<double, ilp_chain_counts.size()> ilp_curve = [] {
+    std::array<double, ilp_chain_counts.size()> r;
+    r.fill(std::numeric_limits<double>::quiet_NaN());
+    return r;
+  }();
+  // package and core energy per call in nJ (BENCH_ENERGY), NaN if unavailable
+  double energy = std::numeric_limits<double>::quiet_NaN();
+  double energy_core = std::numeric_limits<double>::quiet_NaN();
+  // BENCH_COUNTERS events per call, NaN if unavailable
+  std::array<double, max_counters> counters = [] {
+    std::array<double, max_counters> r;
+    r.fill(std::numeric_limits<double>::quiet_NaN());
+    return r;
+  }();
+
+  constexpr
+  Measurement() = default;
+
+  explicit constexpr
+  Measurement(double x)
+  : value(x), min(x), median(x), p90(x), ci_low(x), ci_high(x), raw_median(x)
+  {}
+
+  constexpr
+  operator double() const
+  { return value; }
+
+  template <typename K>
+    requires std::is_arithmetic_v<K>
+    friend constexpr Measurement
+    operator*(K factor, Measurement m)
+    {
+      const double k = factor;
+      m.value *= k;
+      m.min *= k;
+      m.median *= k;
+      m.p90 *= k;
+      m.mad *= k < 0 ? -k : k;
+      m.ci_low *= k;
+      m.ci_high *= k;
+      if (k < 0)
+        std::swap(m.ci_low, m.ci_high);
+      m.overhead *= k;
+      m.raw_median *= k;
+      m.fit_intercept *= k;
+      m.energy *= k;
+      m.energy_core *= k;
+      for (double& c : m.ilp_curve)
+        c *= k;
+      for (double& c : m.counters)
+        c *= k;
+      return m;
+    }
+
+  template <typename K>
+    requires std::is_arithmetic_v<K>
+    friend constexpr Measurement
+    operator*(const Measurement& m, K k)
+    { return k * m; }
+
+  template <typename K>
+    requires std::is_arithmetic_v<K>
+    friend constexpr Measurement
+    operator/(const Measurement& m, K k)
+    { return (1 / double(k)) * m; }
+
+  friend Measurement
+  operator-(const Measurement& a, const Measurement& b)
+  {
+    Measurement r;
+    r.value = a.value - b.value;
+    r.min = a.min - b.min;
+    r.median = a.median - b.median;
+    r.p90 = a.p90 - b.p90;
+    r.mad = std::hypot(a.mad, b.mad);
+    const double half_width = std::hypot(a.ci_high - a.ci_low, b.ci_high - b.ci_low) / 2;
+    r.ci_low = r.median - half_width;
+    r.ci_high = r.median + half_width;
+    r.samples = std::min(a.samples, b.samples);
+    r.overhead = a.overhead - b.overhead;
+    r.raw_median = a.raw_median - b.raw_median;
+    r.fit_intercept = a.fit_intercept - b.fit_intercept;
+    r.energy = a.energy - b.energy;
+    r.energy_core = a.energy_core - b.energy_core;
+    r.fit_r2 = is_nan(b.fit_r2) ? a.fit_r2 : is_nan(a.fit_r2) ? b.fit_r2
+                                                : std::min(a.fit_r2, b.fit_r2);
+    for (std::size_t i = 0; i < r.ilp_curve.size(); ++i)
+      r.ilp_curve[i] = a.ilp_curve[i] - b.ilp_curve[i];
+    for (int i = 0; i < max_counters; ++i)
+      r.counters[i] = a.counters[i] - b.counters[i];
+    return r;
+  }
+};
+
+/**
+ * Whether all BENCH_FILTER terms for \p key accept \p value.
+ */
+inline bool
+filter_accepts(std::string_view key, const std::string& value)
+{
+  for (const auto& [term_key, patterns] : bench_options().filter)
+    {
+      if (term_key != key)
+        continue;
+      bool accepted = false;
+      std::string_view rest = patterns;
+      while (not accepted)
+        {
+          const std::string pattern(rest.substr(0, rest.find('|')));
+          accepted = fnmatch(pattern.c_str(), value.c_str(), 0) == 0;
+          if (pattern.size() >= rest.size())
+            break;
+          rest.remove_prefix(pattern.size() + 1);
+        }
+      if (not accepted)
+        return false;
+    }
+  return true;
+}
+
+/**
+ * Counts the work done by time_mean and time_mean2 since the last reset.
+ */
+struct TimingLog
+{
+  long timings = 0;
+  long batches = 0;
+  long iterations = 0;
+};
+
+inline thread_local TimingLog timing_log = {};
+
+inline long
+monotonic_ns()
+{
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1'000'000'000l + t.tv_nsec;
+}
+
+/**
+ * The CLOCK_MONOTONIC time at which the BENCH_TIME_BUDGET of the current row is
+ * used up, or 0.
+ */
+inline thread_local long row_deadline_ns = 0;
+
+/**
+ * Whether the current row runs in profile mode (BENCH_PROFILE).
+ */
+inline thread_local bool profiling = false;
+
+/**
+ * Enables or disables the external profiler via BENCH_PROFILE_CTL around the
+ * timing loops of a profiled row.
+ */
+[[gnu::noinline]] inline void
+profile_toggle(bool enable)
+{
+  const BenchOptions& opts = bench_options();
+  if (opts.profile_ctl < 0)
+    return;
+  const std::string_view cmd = enable ? "enable\n" : "disable\n";
+  if (write(opts.profile_ctl, cmd.data(), cmd.size()) != ssize_t(cmd.size()))
+    {
+      std::cerr << "BENCH_PROFILE_CTL: write failed: " << std::strerror(errno) << '\n';
+      std::exit(1);
+    }
+  if (opts.profile_ack >= 0)
+    {
+      // perf answers with "ack\n"
+      char c = 0;
+      while (c != '\n' and read(opts.profile_ack, &c, 1) == 1)
+        ;
+    }
+}
+
+/**
+ * Cost of the timing harness itself, measured once per process: reading the
+ * cycle counter twice per batch, and one iteration of the empty loop of
+ * time_mean and time_mean2. SampleCollector subtracts the timer cost from every
+ * batch and, with BENCH_OVERHEAD=loop, the loop cost from every iteration.
+ * (time_latency and time_throughput subtract a fake run, which cancels the
+ * overhead anyway.)
+ *
+ * Out-of-order execution can overlap the loop overhead with the benchmarked
+ * code, so it is an upper bound of what the loop adds. Subtracting it can
+ * report sub-cycle throughput that no core achieves, which is why it is not the
+ * default.
+ */
+struct TimingOverhead
+{
+  // cycles per batch
+  double timer = 0;
+  // cycles per iteration
+  double time_mean = 0;
+  double time_mean2 = 0;
+};
+
+inline const TimingOverhead&
+timing_overhead();
+
+/**
+ * Times the batches of one timing run and decides when to stop: after at least
+ * \p min_batches, as soon as the confidence interval of the median is narrow
+ * enough (BENCH_CI_WIDTH) or BENCH_MAX_BATCHES is reached.
+ *
+ * The first batches calibrate the batch size: starting from 16 iterations, the
+ * size grows until a batch takes BENCH_BATCH_TIME. These batches double as
+ * warm-up and are not part of the statistics.
+ *
+ * The BENCH_COUNTERS are read outside of the timed interval and accumulated
+ * over all batches.
+ */
+class SampleCollector
+{
+  std::vector<double> samples;
+  std::size_t min_batches;
+  std::size_t max_batches;
+  unsigned long batch_start = 0;
+  long iterations = 0;
+  long batch = 16;
+  bool calibrated = false;
+  long last_ns = monotonic_ns();
+  double timer_overhead = 0;
+  double loop_overhead = 0;
+  bool counting = perf_counters().size() > 0;
+  std::array<std::uint64_t, max_counters> counters_start = {};
+  std::array<double, max_counters> counters_sum = {};
+  // RAPL counters at the end of the calibration (BENCH_ENERGY)
+  bool metering = bool(energy_meter());
+  double energy_start = 0;
+  double energy_core_start = 0;
+
+  // indexes of the order statistics bounding the 95% confidence interval of the
+  // median of n samples
+  static std::pair<std::size_t, std::size_t>
+  median_ci_ranks(std::size_t n)
+  {
+    const double half = 1.96 * std::sqrt(double(n)) / 2;
+    const double lo = std::floor(n / 2. - half);
+    const double hi = std::ceil(n / 2. + half);
+    return {lo < 1 ? 0 : std::size_t(lo) - 1, std::min(n - 1, std::size_t(hi))};
+  }
+
+  static double
+  sorted_median(const std::vector<double>& x)
+  {
+    const std::size_t n = x.size();
+    return n % 2 == 1 ? x[n / 2] : (x[n / 2 - 1] + x[n / 2]) / 2;
+  }
+
+public:
+  /**
+   * \p iterations is the batch size if BENCH_BATCH_TIME is 0. \p loop selects
+   * the loop overhead of the calling timing function.
+   */
+  [[gnu::noinline]]
+  SampleCollector(int retries, long iterations, double TimingOverhead::* loop)
+  : min_batches(std::max(retries, 1)),
+    max_batches(std::max(bench_options().max_batches > 0 ? bench_options().max_batches
+                                                           : 10 * retries, retries)),
+    timer_overhead(timing_overhead().timer),
+    loop_overhead(bench_options().overhead == BenchOptions::Overhead::loop
+                    ? timing_overhead().*loop : 0.)
+  {
+    samples.reserve(max_batches);
+    if (bench_options().batch_time_ns <= 0)
+      {
+        batch = iterations;
+        calibrated = true;
+        if (metering)
+          energy_meter().read(energy_start, energy_core_start);
+      }
+  }
+
+  /**
+   * The number of iterations the next batch must run.
+   */
+  long
+  batch_size() const
+  { return batch; }
+
+  [[gnu::always_inline]] void
+  start_batch()
+  {
+    if (counting)
+      read_counters_start();
+    batch_start = cycle_clock().now();
+  }
+
+  [[gnu::noinline]] void
+  read_counters_start()
+  { counting = perf_counters().read(counters_start.data()); }
+
+  [[gnu::always_inline]] void
+  stop_batch(long batch_iterations)
+  {
+    const unsigned long batch_end = cycle_clock().now();
+    add_sample(batch_end - batch_start, batch_iterations);
+  }
+
+  [[gnu::noinline]] void
+  add_sample(unsigned long cycles, long batch_iterations)
+  {
+    std::array<std::uint64_t, max_counters> counters_end;
+    const bool counted = counting and (counting = perf_counters().read(counters_end.data()));
+    timing_log.iterations += batch_iterations;
+    const long now = monotonic_ns();
+    const long elapsed = now - std::exchange(last_ns, now);
+    if (not calibrated)
+      {
+        const long target = bench_options().batch_time_ns;
+        if (elapsed >= target or batch >= (1l << 40))
+          {
+            calibrated = true;
+            if (metering)
+              energy_meter().read(energy_start, energy_core_start);
+          }
+        else
+          batch = long(batch * std::clamp(1.4 * target / std::max(elapsed, 1l), 2., 10.));
+        return;
+      }
+    samples.push_back((double(cycles) - timer_overhead) / batch_iterations - loop_overhead);
+    iterations += batch_iterations;
+    ++timing_log.batches;
+    if (counted)
+      for (int i = 0; i < perf_counters().size(); ++i)
+        counters_sum[i] += double(counters_end[i] - counters_start[i]);
+  }
+
+  [[gnu::noinline]] bool
+  done() const
+  {
+    const std::size_t n = samples.size();
+    if (row_deadline_ns != 0 and n >= 3 and monotonic_ns() > row_deadline_ns)
+      return true;
+    if (n < min_batches)
+      return false;
+    if (n >= max_batches)
+      return true;
+    std::vector<double> x = samples;
+    std::ranges::sort(x);
+    const double median = sorted_median(x);
+    const auto [lo, hi] = median_ci_ranks(n);
+    return x[hi] - x[lo] <= bench_options().ci_width * std::abs(median);
+  }
+
+  [[gnu::noinline]] Measurement
+  result() const
+  {
+    Measurement m;
+    const std::size_t n = samples.size();
+    if (n == 0)
+      return m;
+    std::vector<double> x = samples;
+    std::ranges::sort(x);
+    m.samples = n;
+    m.min = x.front();
+    m.median = sorted_median(x);
+    m.p90 = x[std::size_t(std::ceil(0.9 * n)) - 1];
+    const auto [lo, hi] = median_ci_ranks(n);
+    m.ci_low = x[lo];
+    m.ci_high = x[hi];
+    for (double& y : x)
+      y = std::abs(y - m.median);
+    std::ranges::sort(x);
+    m.mad = sorted_median(x);
+    m.value = bench_options().estimator == BenchOptions::Estimator::min ? m.min : m.median;
+    m.overhead = timer_overhead * n / iterations + loop_overhead;
+    m.raw_median = m.median + m.overhead;
+    if (counting)
+      for (int i = 0; i < perf_counters().size(); ++i)
+        m.counters[i] = counters_sum[i] / iterations;
+    if (metering)
+      {
+        // includes the loop and timer overhead, unlike the cycles
+        const EnergyMeter& meter = energy_meter();
+        double end, end_core;
+        meter.read(end, end_core);
+        m.energy = meter.nanojoules(energy_start, end) / iterations;
+        m.energy_core = meter.nanojoules(energy_core_start, end_core, true) / iterations;
+      }
+    return m;
+  }
+};
+
+template <int N>
+  using Info = std::array<const char*, N>;
+
+/**
+ * Column names of the byte offsets 0 to 63 (see Misaligned).
+ */
+inline constexpr const char* byte_offset_names[64] = {
+  "+0", "+1", "+2", "+3", "+4", "+5", "+6", "+7", "+8", "+9", "+10", "+11", "+12", "+13",
+  "+14", "+15", "+16", "+17", "+18", "+19", "+20", "+21", "+22", "+23", "+24", "+25",
+  "+26", "+27", "+28", "+29", "+30", "+31", "+32", "+33", "+34", "+35", "+36", "+37",
+  "+38", "+39", "+40", "+41", "+42", "+43", "+44", "+45", "+46", "+47", "+48", "+49",
+  "+50", "+51", "+52", "+53", "+54", "+55", "+56", "+57", "+58", "+59", "+60", "+61",
+  "+62", "+63"
+};
+
+/**
+ * ExtraFlags for the misalignment sweeps of store and maskedstore. The columns
+ * of Benchmark<Special, Misaligned<First>> are accesses at the byte offsets
+ * First to First + 7 from a page-aligned address; bench_all for First = 0, 8,
+ * ..., 56 thus covers every position within a cache line.
+ */
+template <int First>
+  requires (First >= 0 and First + 8 <= 64)
+  struct Misaligned
+  {
+    static constexpr char name[] = {'+', char('0' + First / 10), char('0' + First % 10), '.', '.',
+                                    char('0' + (First + 7) / 10), char('0' + (First + 7) % 10),
+                                    '\0'};
+
+    static constexpr bool page_split = false;
+
+    static constexpr Info<8> info = [] {
+      Info<8> r;
+      for (int i = 0; i < 8; ++i)
+        r[i] = byte_offset_names[First + i];
+      return r;
+    }();
+
+    static constexpr std::array<int, 8> offsets = [] {
+      std::array<int, 8> r;
+      for (int i = 0; i < 8; ++i)
+        r[i] = First + i;
+      return r;
+    }();
+  };
+
+/**
+ * ExtraFlags for the page-split positions of the misalignment sweeps: accesses
+ * starting 0, 1, 4, 16, and 32 bytes before a 4 KiB page boundary, i.e.
+ * crossing it if wider than that.
+ */
+struct PageSplit
+{
+  static constexpr char name[] = "page split";
+
+  static constexpr bool page_split = true;
 
-template <int N>
-  using Info = std::array<const char*, N>;
+  static constexpr Info<5> info = {"page+0", "page-1", "page-4", "page-16", "page-32"};
+
+  static constexpr std::array<int, 5> offsets = {0, -1, -4, -16, -32};
+};
 
 template <int N>
   struct Times
   {
     std::array<double, N> cycles_per_call;
+    std::array<Measurement, N> stats;
     int size;
 
     using DoubleN = double[N];
 
     constexpr
-    Times(std::floating_point auto... init)
-    : cycles_per_call{init...}, size(-1)
+    Times(const std::convertible_to<double> auto&... init)
+    : cycles_per_call{double(init)...}, stats{Measurement(init)...}, size(-1)
     { static_assert(sizeof...(init) == N); }
 
     constexpr
     Times(const std::array<double, N>& init, int init_size)
     : cycles_per_call(init), size(init_size)
+    {
+      for (int i = 0; i < N; ++i)
+        stats[i] = Measurement(init[i]);
+    }
+
+    constexpr
+    Times(const Times& init, int init_size)
+    : cycles_per_call(init.cycles_per_call), stats(init.stats), size(init_size)
     {}
 
     constexpr double
@@ -223,6 +1757,233 @@ template <int N>
     { return cycles_per_call[i]; }
   };
 
+/**
+ * The columns of the CSV output: those of the result records (see report_cell)
+ * followed by those only the scaling records have (see report_scaling), whose
+ * "record" field is "scaling".
+ */
+[[gnu::noinline]] inline const std::vector<std::string>&
+csv_columns()
+{
+  static const std::vector<std::string> columns = [] {
+    std::vector<std::string> r = {
+      "record", "benchmark", "type", "abi", "width", "flags", "column", "cycles_per_call",
+      "min", "median", "p90", "mad", "ci_low", "ci_high", "samples", "overhead", "raw_median",
+      "fit_intercept", "fit_r2", "ilp_curve", "ilp_knee", "ilp_spill", "speedup",
+      "speedup_low", "speedup_high", "timings", "batches", "iterations", "clock", "ghz",
+      "throttled", "nj_per_call", "nj_per_value", "nj_core_per_call"};
+    for (const auto& counter : bench_options().counters)
+      r.push_back(counter.first);
+    for (const char* key : {"bytes_per_call", "bytes_per_cycle", "gb_per_s",
+                            "elements_per_cycle", "threads", "sibling", "max", "aggregate",
+                            "pinned"})
+      r.push_back(key);
+    return r;
+  }();
+  return columns;
+}
+
+/**
+ * One row of machine-readable output. Columns are appended in order via
+ * operator(). A JSON Lines record has exactly these; a CSV row has all of
+ * csv_columns(), with empty fields for those the record does not have.
+ */
+class ResultRecord
+{
+  std::string json = "{";
+  std::vector<std::pair<const char*, std::string>> csv;
+
+  void
+  add_key(const char* key)
+  {
+    if (not csv.empty())
+      json += ", ";
+    json += '"';
+    json += key;
+    json += "\": ";
+    csv.emplace_back(key, "");
+  }
+
+public:
+  ResultRecord&
+  operator()(const char* key, std::string_view value)
+  {
+    add_key(key);
+    std::string& field = csv.back().second;
+    json += '"';
+    field += '"';
+    for (char c : value)
+      {
+        if (c == '"' or c == '\\')
+          json += '\\';
+        if (static_cast<unsigned char>(c) < 0x20)
+          {
+            char esc[8];
+            std::snprintf(esc, sizeof(esc), "\\u%04x", c);
+            json += esc;
+          }
+        else
+          json += c;
+        if (c == '"')
+          field += '"';
+        field += c;
+      }
+    json += '"';
+    field += '"';
+    return *this;
+  }
+
+  ResultRecord&
+  operator()(const char* key, std::integral auto value)
+  {
+    add_key(key);
+    const std::string str = std::to_string(value);
+    json += str;
+    csv.back().second = str;
+    return *this;
+  }
+
+  ResultRecord&
+  operator()(const char* key, std::floating_point auto value)
+  {
+    add_key(key);
+    if (is_finite(value))
+      {
+        char str[32];
+        std::snprintf(str, sizeof(str), "%.6g", double(value));
+        json += str;
+        csv.back().second = str;
+      }
+    else
+      json += "null";
+    return *this;
+  }
+
+  void
+  emit() const
+  {
+    const BenchOptions& opts = bench_options();
+    if (opts.format == BenchOptions::Format::jsonl)
+      std::fprintf(opts.output, "%s}\n", json.c_str());
+    else if (opts.format == BenchOptions::Format::csv)
+      {
+        const std::vector<std::string>& columns = csv_columns();
+        for (const auto& [key, value] : csv)
+          if (std::find(columns.begin(), columns.end(), key) == columns.end())
+            {
+              std::cerr << "ResultRecord: '" << key << "' is not in csv_columns()\n";
+              std::exit(1);
+            }
+        std::string row;
+        static bool header_written = false;
+        if (not std::exchange(header_written, true))
+          {
+            for (const std::string& column : columns)
+              row += (row.empty() ? "" : ",") + column;
+            row += '\n';
+          }
+        for (std::size_t i = 0; i < columns.size(); ++i)
+          {
+            if (i > 0)
+              row += ',';
+            for (const auto& [key, value] : csv)
+              if (key == columns[i])
+                row += value;
+          }
+        std::fprintf(opts.output, "%s\n", row.c_str());
+      }
+    else
+      return;
+    std::fflush(opts.output);
+  }
+};
+
+/**
+ * Name of the benchmark, derived from the main source file.
+ */
+constexpr std::string_view
+bench_name()
+{
+  std::string_view name = __BASE_FILE__;
+  name.remove_prefix(name.find_last_of('/') + 1);
+  if (name.ends_with(".cpp"))
+    name.remove_suffix(4);
+  return name;
+}
+
+/**
+ * Name of the value type, right-aligned to 6 characters for the table.
+ */
+template <typename T>
+  constexpr const char*
+  value_type_name()
+  {
+    if constexpr (std::is_same_v<T, float>)
+      return " float";
+    else if constexpr (std::is_same_v<T, double>)
+      return "double";
+    else if constexpr (std::is_same_v<T, long double>)
+      return "ldoubl";
+#ifdef __STDCPP_FLOAT16_T__
+    else if constexpr (std::is_same_v<T, std::float16_t>)
+      return " flt16";
+#endif
+#ifdef __STDCPP_FLOAT32_T__
+    else if constexpr (std::is_same_v<T, std::float32_t>)
+      return " flt32";
+#endif
+#ifdef __STDCPP_FLOAT64_T__
+    else if constexpr (std::is_same_v<T, std::float64_t>)
+      return " flt64";
+#endif
+    else if constexpr (std::is_same_v<T, long long>)
+      return " llong";
+    else if constexpr (std::is_same_v<T, unsigned long long>)
+      return "ullong";
+    else if constexpr (std::is_same_v<T, long>)
+      return "  long";
+    else if constexpr (std::is_same_v<T, unsigned long>)
+      return " ulong";
+    else if constexpr (std::is_same_v<T, int>)
+      return "   int";
+    else if constexpr (std::is_same_v<T, unsigned>)
+      return "  uint";
+    else if constexpr (std::is_same_v<T, short>)
+      return " short";
+    else if constexpr (std::is_same_v<T, unsigned short>)
+      return "ushort";
+    else if constexpr (std::is_same_v<T, char>)
+      return "  char";
+    else if constexpr (std::is_same_v<T, signed char>)
+      return " schar";
+    else if constexpr (std::is_same_v<T, unsigned char>)
+      return " uchar";
+#if __cpp_char8_t >= 201811L
+    else if constexpr (std::is_same_v<T, char8_t>)
+      return " char8";
+#endif
+    else if constexpr (std::is_same_v<T, char16_t>)
+      return "char16";
+    else if constexpr (std::is_same_v<T, char32_t>)
+      return "char32";
+    else if constexpr (std::is_same_v<T, wchar_t>)
+      return " wchar";
+    else
+      return "??????";
+  }
+
+/**
+ * Identifies the row passed to bench_lat_thr.
+ */
+struct BenchCell
+{
+  // the row prefix of the ANSI table
+  const char* id;
+  std::string_view type;
+  std::string abi;
+  std::string flags;
+};
+
 template <int Special, class...>
   struct Benchmark
   { static_assert("The benchmark must specialize this type."); };
@@ -230,6 +1991,24 @@ template <int Special, class...>
 struct NoRef
 { static constexpr int size = -1; };
 
+/**
+ * Benchmarks of memory bandwidth define the bytes read and written per byte of
+ * the vector in each column (e.g. 2 for a copy) as
+ * `static constexpr std::array<double, N> traffic`. This adds the B/cycle and
+ * GB/s columns.
+ */
+template <typename B>
+  concept has_traffic = requires { { B::traffic[0] } -> std::convertible_to<double>; };
+
+/**
+ * Benchmarks of element-wise memory access (e.g. gathers) define the elements
+ * accessed per element of the vector in each column (0 where it does not
+ * apply, e.g. for a latency) as `static constexpr std::array<double, N>
+ * elements`. This adds the elements/cycle column.
+ */
+template <typename B>
+  concept has_elements = requires { { B::elements[0] } -> std::convertible_to<double>; };
+
 template <typename T, typename B>
   concept accept_type_for_benchmark
     = std::default_initializable<T>
@@ -239,47 +2018,454 @@ template <typename T, typename B>
 template <class T, class B, class Ref = NoRef>
   requires (not accept_type_for_benchmark<T, B>)
   Ref
-  bench_lat_thr(const char*, const Ref& ref = {})
+  bench_lat_thr(const BenchCell&, const Ref& ref = {})
   { return ref; }
 
+/**
+ * Evaluates an ILP sweep (Measurement::ilp_curve): \p knee is the smallest
+ * number of chains that comes within 5% of the best throughput, \p spill the
+ * smallest number of chains beyond the best one that is more than 10% slower
+ * than the best, i.e. where adding chains starts to hurt. Both are 0 if
+ * unknown.
+ */
+inline void
+ilp_knee_and_spill(const Measurement& m, int& knee, int& spill)
+{
+  knee = spill = 0;
+  std::size_t best = m.ilp_curve.size();
+  for (std::size_t i = 0; i < m.ilp_curve.size(); ++i)
+    if (m.ilp_curve[i] > 0 and (best == m.ilp_curve.size() or m.ilp_curve[i] < m.ilp_curve[best]))
+      best = i;
+  if (best == m.ilp_curve.size())
+    return;
+  for (std::size_t i = 0; i <= best and knee == 0; ++i)
+    if (m.ilp_curve[i] <= 1.05 * m.ilp_curve[best])
+      knee = ilp_chain_counts[i];
+  for (std::size_t i = best + 1; i < m.ilp_curve.size() and spill == 0; ++i)
+    if (m.ilp_curve[i] > 1.1 * m.ilp_curve[best])
+      spill = ilp_chain_counts[i];
+}
+
+/**
+ * Prints one row of the table and writes its result records. \p ref is null for
+ * the reference row, otherwise it points to \p columns measurements of
+ * \p ref_size values each. \p bytes (null unless the benchmark defines traffic)
+ * holds the bytes of memory traffic per call of each column, \p elements (null
+ * unless the benchmark defines elements) the elements accessed per call.
+ */
+[[gnu::noinline]] inline void
+report_cell(const BenchCell& cell, int size, int speedup_size, const char* const* info,
+            int columns, const Measurement* results, const Measurement* ref, int ref_size,
+            const double* bytes, const double* elements, const TimingLog& log, double ghz,
+            bool throttled)
+{
+  static constexpr char red[] = "\033[1;40;31m";
+  static constexpr char green[] = "\033[1;40;32m";
+  static constexpr char dgreen[] = "\033[0;40;32m";
+  static constexpr char normal[] = "\033[0m";
+
+  // speedup and its bounds from the confidence intervals of both measurements
+  std::vector<double> speedups(columns, 1.), speedups_low(columns, 1.),
+                      speedups_high(columns, 1.);
+  if (ref != nullptr)
+    for (int i = 0; i < columns; ++i)
+      {
+        const double scale = double(size) / ref_size;
+        speedups[i] = ref[i].value * scale / results[i].value;
+        speedups_low[i] = ref[i].ci_low * scale / results[i].ci_high;
+        speedups_high[i] = ref[i].ci_high * scale / results[i].ci_low;
+      }
+
+  // bandwidth: cycles of the TSC tick at its calibrated frequency, core cycles
+  // at the effective frequency
+  const double clock_ghz = cycle_clock().name() == std::string_view("tsc")
+                             ? frequency_monitor().tsc_frequency() : ghz;
+  std::vector<double> bytes_per_cycle(columns, std::numeric_limits<double>::quiet_NaN());
+  if (bytes != nullptr)
+    for (int i = 0; i < columns; ++i)
+      bytes_per_cycle[i] = bytes[i] / results[i].value;
+  std::vector<double> elements_per_cycle(columns, std::numeric_limits<double>::quiet_NaN());
+  if (elements != nullptr)
+    for (int i = 0; i < columns; ++i)
+      if (elements[i] > 0)
+        elements_per_cycle[i] = elements[i] / results[i].value;
+
+  if (bench_options().table)
+    {
+      std::cout << cell.id;
+      for (int i = 0; i < columns; ++i)
+        {
+          const double speedup = speedups[i];
+          std::cout << std::setprecision(3) << std::setw(15) << results[i].value;
+          if (speedup_size <= ref_size)
+            {
+              if (speedup >= 1.1)
+                std::cout << green;
+              else if (speedup > 0.995)
+                std::cout << dgreen;
+              else
+                std::cout << red;
+            }
+          else if (speedup >= speedup_size * 0.90 / ref_size && speedup >= 1.5)
+            std::cout << green;
+          else if (speedup > 1.1)
+            std::cout << dgreen;
+          else if (speedup < 0.95)
+            std::cout << red;
+          std::cout << std::setw(12) << speedup << normal;
+          for (int c = 0; c < perf_counters().size(); ++c)
+            {
+              if (is_nan(results[i].counters[c]))
+                std::cout << std::setw(12) << "n/a";
+              else
+                std::cout << std::setw(12) << results[i].counters[c];
+            }
+          if (energy_meter())
+            {
+              if (is_nan(results[i].energy))
+                std::cout << std::setw(12) << "n/a";
+              else
+                std::cout << std::setw(12) << results[i].energy / size;
+            }
+          if (bytes != nullptr)
+            std::cout << std::setw(10) << bytes_per_cycle[i] << std::setw(10)
+                      << bytes_per_cycle[i] * clock_ghz;
+          if (elements != nullptr)
+            {
+              if (is_nan(elements_per_cycle[i]))
+                std::cout << std::setw(12) << "";
+              else
+                std::cout << std::setw(12) << elements_per_cycle[i];
+            }
+        }
+      if (frequency_monitor())
+        {
+          char str[16];
+          std::snprintf(str, sizeof(str), "%8.2f", ghz);
+          std::cout << (throttled ? red : "") << str << (throttled ? "!" : " ") << normal;
+        }
+      for (int i = 0; i < columns; ++i)
+        {
+          int knee, spill;
+          ilp_knee_and_spill(results[i], knee, spill);
+          if (knee > 0)
+            std::cout << "  " << info[i] << " ILP knee " << knee;
+          if (spill > 0)
+            std::cout << red << " spill " << spill << normal;
+        }
+      std::cout << std::endl;
+    }
+
+  for (int i = 0; i < columns; ++i)
+    {
+      std::string curve;
+      for (std::size_t k = 0; k < ilp_chain_counts.size(); ++k)
+        if (not is_nan(results[i].ilp_curve[k]))
+          {
+            char point[32];
+            std::snprintf(point, sizeof(point), "%s%d:%.4g", curve.empty() ? "" : ";",
+                          ilp_chain_counts[k], results[i].ilp_curve[k]);
+            curve += point;
+          }
+      int knee, spill;
+      ilp_knee_and_spill(results[i], knee, spill);
+
+      ResultRecord record;
+      record
+      ("benchmark", bench_name())
+      ("type", cell.type)
+      ("abi", cell.abi)
+      ("width", size)
+      ("flags", cell.flags)
+      ("column", info[i])
+      ("cycles_per_call", results[i].value)
+      ("min", results[i].min)
+      ("median", results[i].median)
+      ("p90", results[i].p90)
+      ("mad", results[i].mad)
+      ("ci_low", results[i].ci_low)
+      ("ci_high", results[i].ci_high)
+      ("samples", results[i].samples)
+      ("overhead", results[i].overhead)
+      ("raw_median", results[i].raw_median)
+      ("fit_intercept", results[i].fit_intercept)
+      ("fit_r2", results[i].fit_r2)
+      ("ilp_curve", curve)
+      ("ilp_knee", knee)
+      ("ilp_spill", spill)
+      ("speedup", speedups[i])
+      ("speedup_low", speedups_low[i])
+      ("speedup_high", speedups_high[i])
+      ("timings", log.timings)
+      ("batches", log.batches)
+      ("iterations", log.iterations)
+      ("clock", cycle_clock().name())
+      ("ghz", ghz)
+      ("throttled", int(throttled))
+      ("nj_per_call", results[i].energy)
+      ("nj_per_value", results[i].energy / size)
+      ("nj_core_per_call", results[i].energy_core);
+      for (int c = 0; c < perf_counters().size(); ++c)
+        record(bench_options().counters[c].first.c_str(), results[i].counters[c]);
+      if (bytes != nullptr)
+        record("bytes_per_call", bytes[i])("bytes_per_cycle", bytes_per_cycle[i])
+              ("gb_per_s", bytes_per_cycle[i] * clock_ghz);
+      if (elements != nullptr)
+        record("elements_per_cycle", elements_per_cycle[i]);
+      record.emit();
+    }
+}
+
+/**
+ * Reports one configuration of the scaling mode (see measure_scaling):
+ * \p per_thread holds the cycles/call of every thread and column, \p single
+ * those of the row measured alone.
+ */
+[[gnu::noinline]] inline void
+report_scaling(const BenchCell& cell, int size, const char* const* info, int columns,
+               const double* single, const std::vector<double>& per_thread,
+               BenchOptions::Sibling sibling, int pin_error)
+{
+  static constexpr const char* sibling_names[] = {"none", "same", "fma"};
+  const char* const sibling_name = sibling_names[int(sibling)];
+  const int threads = int(per_thread.size()) / columns;
+  if (pin_error != 0)
+    std::cerr << "BENCH_THREADS: cannot pin all " << threads << " threads: "
+              << std::strerror(pin_error) << '\n';
+
+  std::vector<double> median(columns), min(columns), max(columns), aggregate(columns);
+  for (int i = 0; i < columns; ++i)
+    {
+      std::vector<double> values;
+      for (int t = 0; t < threads; ++t)
+        values.push_back(per_thread[t * columns + i]);
+      std::sort(values.begin(), values.end());
+      median[i] = values.size() % 2 ? values[values.size() / 2]
+                                    : (values[values.size() / 2 - 1] + values[values.size() / 2]) / 2;
+      min[i] = values.front();
+      max[i] = values.back();
+      for (double v : values)
+        aggregate[i] += single[i] / v;
+    }
+
+  const BenchOptions& opts = bench_options();
+  if (opts.table)
+    {
+      char label[64];
+      std::snprintf(label, sizeof(label), "  %d thread%s%s%s", threads, threads == 1 ? "" : "s",
+                    sibling == BenchOptions::Sibling::none ? "" : ", sibling ",
+                    sibling == BenchOptions::Sibling::none ? "" : sibling_name);
+      std::cout << std::left << std::setw(std::strlen(cell.id)) << label << std::right;
+      for (int i = 0; i < columns; ++i)
+        std::cout << std::setprecision(3) << std::setw(15) << median[i] << std::setw(11)
+                  << aggregate[i] << 'x';
+      std::cout << std::endl;
+    }
+
+  for (int i = 0; i < columns; ++i)
+    {
+      ResultRecord()
+      ("record", "scaling")
+      ("benchmark", bench_name())
+      ("type", cell.type)
+      ("abi", cell.abi)
+      ("width", size)
+      ("flags", cell.flags)
+      ("column", info[i])
+      ("threads", threads)
+      ("sibling", sibling_name)
+      ("cycles_per_call", median[i])
+      ("min", min[i])
+      ("max", max[i])
+      ("aggregate", aggregate[i])
+      ("pinned", int(pin_error == 0))
+      .emit();
+    }
+}
+
+/**
+ * Keeps the floating-point units of the calling core busy until \p running
+ * drops to 0: independent multiply-adds on native vectors (FMAs if the target
+ * has them). The kernel of BENCH_SIBLING=fma.
+ */
+[[gnu::noinline]] inline void
+fma_loop(const std::atomic<int>& running)
+{
+  using V [[gnu::vector_size(sizeof(simd<double>))]] = double;
+  V x[8] = {};
+  while (running.load(std::memory_order_relaxed) > 0)
+    {
+      for (int i = 0; i < 4096; ++i)
+        for (V& v : x)
+          v = v * 0.999 + 1.;
+      asm volatile("" : "+m"(x));
+    }
+}
+
+/**
+ * The scaling mode (BENCH_THREADS): for every requested thread count n, runs
+ * \p kernel on n threads at once, each pinned to its own physical core (see
+ * CoreTopology) and released together by a barrier. With BENCH_SIBLING, the
+ * same is repeated with the SMT siblings of these cores busy. Threads that are
+ * done keep running the kernel until the slowest one is done as well.
+ * Benchmarks that write to memory must use per-thread buffers (e.g.
+ * thread_buffer or thread_local arrays).
+ *
+ * Reports per table column the median cycles/call of the n threads and the
+ * aggregate throughput relative to \p single (the row measured alone), i.e.
+ * the sum of single / per-thread cycles/call, which is n for perfect scaling.
+ */
+template <int N>
+  [[gnu::noinline]] void
+  measure_scaling(const BenchCell& cell, int size, const char* const* info, Times<N> (*kernel)(),
+                  const Times<N>& single)
+  {
+    const BenchOptions& opts = bench_options();
+    const std::vector<CoreTopology::Core>& cores = core_topology().cores;
+    std::vector<int> counts = opts.threads;
+    if (counts == std::vector{0})
+      {
+        counts.clear();
+        for (int n = 1; n <= int(cores.size()); ++n)
+          counts.push_back(n);
+      }
+    std::vector<BenchOptions::Sibling> configs = {BenchOptions::Sibling::none};
+    if (opts.sibling != BenchOptions::Sibling::none)
+      configs.push_back(opts.sibling);
+    double single_values[N];
+    for (int i = 0; i < N; ++i)
+      single_values[i] = single.stats[i].value;
+
+    for (const BenchOptions::Sibling sibling : configs)
+      for (const int n : counts)
+        {
+          static bool warned = false;
+          if (n > int(cores.size()))
+            {
+              if (not std::exchange(warned, true))
+                std::cerr << "BENCH_THREADS: skipping more than " << cores.size()
+                          << " threads (the number of cores)\n";
+              continue;
+            }
+          const bool busy = sibling != BenchOptions::Sibling::none;
+          if (busy and std::any_of(cores.begin(), cores.begin() + n,
+                                   [](const CoreTopology::Core& core) { return core.sibling < 0; }))
+            {
+              static bool no_sibling_warned = false;
+              if (not std::exchange(no_sibling_warned, true))
+                std::cerr << "BENCH_SIBLING: skipped, " << n << " cores without SMT sibling\n";
+              break;
+            }
+
+          std::vector<double> per_thread(n * N);
+          std::atomic<int> running = n;
+          std::atomic<int> pin_error = 0;
+          std::barrier start(busy ? 2 * n : n);
+          auto pin = [&](int cpu) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            if (sched_setaffinity(0, sizeof(set), &set) != 0)
+              pin_error = errno;
+          };
+          std::vector<std::thread> threads;
+          for (int t = 0; t < n; ++t)
+            threads.emplace_back([&, t] {
+              pin(cores[t].cpu);
+              start.arrive_and_wait();
+              const Times<N> results = kernel();
+              --running;
+              for (int i = 0; i < N; ++i)
+                per_thread[t * N + i] = results.stats[i].value;
+              // keep up the contention until the slowest thread is done
+              while (running > 0)
+                kernel();
+            });
+          if (busy)
+            for (int t = 0; t < n; ++t)
+              threads.emplace_back([&, t] {
+                pin(cores[t].sibling);
+                start.arrive_and_wait();
+                if (sibling == BenchOptions::Sibling::fma)
+                  fma_loop(running);
+                else
+                  while (running > 0)
+                    kernel();
+              });
+          for (std::thread& thread : threads)
+            thread.join();
+          report_scaling(cell, size, info, N, single_values, per_thread, sibling, pin_error);
+        }
+  }
+
 template <class T, class B, class Ref = NoRef>
   requires accept_type_for_benchmark<T, B>
   Times<B::info.size()>
-  bench_lat_thr(const char* id, const Ref& ref = {})
+  bench_lat_thr(const BenchCell& cell, const Ref& ref = {})
   {
     constexpr int N = B::info.size();
-    static constexpr char red[] = "\033[1;40;31m";
-    static constexpr char green[] = "\033[1;40;32m";
-    static constexpr char dgreen[] = "\033[0;40;32m";
-    static constexpr char normal[] = "\033[0m";
 
-    const Times<N> results = { B::template run<T>().cycles_per_call, size_v<T> };
-    std::cout << id;
-    for (int i = 0; i < N; ++i)
-      {
-        double speedup = 1;
-        if constexpr (!std::is_same_v<Ref, NoRef>)
-          speedup = ref[i] * size_v<T> / (results[i] * ref.size);
+    // the first row of a table is the reference for all others and thus needed
+    if constexpr (not std::same_as<Ref, NoRef>)
+      if (not filter_accepts("width", std::to_string(size_v<T>))
+            or not filter_accepts("abi", cell.abi))
+        return ref;
+
+    FrequencyMonitor& frequency = frequency_monitor();
+    // captureless, so that measure_scaling can run it on other threads
+    auto kernel = [] [[gnu::noinline]] () {
+      if (const long budget = bench_options().time_budget_ns; budget > 0)
+        row_deadline_ns = monotonic_ns() + N * budget;
+      return Times<N>(B::template run<T>(), size_v<T>);
+    };
+    auto measure = [&] [[gnu::noinline]] () {
+      timing_log = {};
+      frequency.start();
+      return kernel();
+    };
+    Times<N> results = measure();
+    for (int attempt = 0; frequency.stop(attempt); ++attempt)
+      results = measure();
+    const TimingLog log = timing_log;
+
+    const Measurement* ref_stats = nullptr;
+    if constexpr (!std::is_same_v<Ref, NoRef>)
+      ref_stats = ref.stats.data();
+    std::array<double, N> bytes = {};
+    if constexpr (has_traffic<B>)
+      for (int i = 0; i < N; ++i)
+        bytes[i] = B::traffic[i] * double(size_v<T> * sizeof(value_type_t<T>));
+    std::array<double, N> elements = {};
+    if constexpr (has_elements<B>)
+      for (int i = 0; i < N; ++i)
+        elements[i] = B::elements[i] * size_v<T>;
+    report_cell(cell, size_v<T>, speedup_size_v<T>, B::info.data(), N, results.stats.data(),
+                ref_stats, ref.size, has_traffic<B> ? bytes.data() : nullptr,
+                has_elements<B> ? elements.data() : nullptr, log, frequency.ghz,
+                frequency.throttled);
+
+    if (const long duration = bench_options().profile_ns; duration > 0)
+      if (filter_accepts("width", std::to_string(size_v<T>)) and filter_accepts("abi", cell.abi))
+        {
+          // the measurement above was the warm-up
+          const long end = monotonic_ns() + duration;
+          long runs = 0;
+          profiling = true;
+          do
+            {
+              measure();
+              ++runs;
+            }
+          while (monotonic_ns() < end);
+          profiling = false;
+          std::cerr << "profiled " << cell.type << ", " << cell.abi << ' ' << cell.flags << " ("
+                    << runs << " runs)\n";
+        }
+
+    if (not bench_options().threads.empty())
+      if (filter_accepts("width", std::to_string(size_v<T>)) and filter_accepts("abi", cell.abi))
+        measure_scaling<N>(cell, size_v<T>, B::info.data(), kernel, results);
 
-        std::cout << std::setprecision(3) << std::setw(15) << results[i];
-        if (speedup_size_v<T> <= ref.size)
-          {
-            if (speedup >= 1.1)
-              std::cout << green;
-            else if (speedup > 0.995)
-              std::cout << dgreen;
-            else
-              std::cout << red;
-          }
-        else if (speedup >= speedup_size_v<T> * 0.90 / ref.size && speedup >= 1.5)
-          std::cout << green;
-        else if (speedup > 1.1)
-          std::cout << dgreen;
-        else if (speedup < 0.95)
-          std::cout << red;
-        std::cout << std::setw(12) << speedup << normal;
-      }
-    std::cout << std::endl;
     if constexpr (std::same_as<Ref, NoRef>)
       return results;
     else
@@ -289,13 +2475,109 @@ template <class T, class B, class Ref = NoRef>
 template <std::size_t N>
   using cstr = char[N];
 
+/**
+ * Sets up the run environment and reports it once per process: in the table
+ * preamble and as the first record of the machine-readable results (a record
+ * with "record": "environment" in JSON Lines, '#' comment lines in CSV).
+ */
+[[gnu::noinline]] inline void
+print_preamble()
+{
+  static bool done = false;
+  if (std::exchange(done, true))
+    return;
+  const RunEnvironment& env = run_environment();
+  const BenchOptions& opts = bench_options();
+  const std::string_view clock = cycle_clock().name();
+  const TimingOverhead& overhead = timing_overhead();
+  std::string warnings;
+  for (const std::string& warning : env.warnings)
+    warnings += (warnings.empty() ? "" : "; ") + warning;
+
+  if (opts.format == BenchOptions::Format::jsonl)
+    {
+      ResultRecord record;
+      record("record", "environment");
+      for (const auto& [key, value] : env.fields)
+        record(key.c_str(), value);
+      record("clock", clock)("frequency", frequency_monitor().name())
+            ("energy", energy_meter().name())
+            ("timer_overhead", overhead.timer)("time_mean_overhead", overhead.time_mean)
+            ("time_mean2_overhead", overhead.time_mean2)("warnings", warnings).emit();
+    }
+  else if (opts.format == BenchOptions::Format::csv)
+    {
+      for (const auto& [key, value] : env.fields)
+        std::fprintf(opts.output, "# %s: %s\n", key.c_str(), value.c_str());
+      std::fprintf(opts.output, "# clock: %s\n# frequency: %s\n# energy: %s\n", clock.data(),
+                   frequency_monitor().name(), energy_meter().name());
+      std::fprintf(opts.output, "# timer_overhead: %g\n# time_mean_overhead: %g\n"
+                                "# time_mean2_overhead: %g\n# warnings: %s\n",
+                   overhead.timer, overhead.time_mean, overhead.time_mean2, warnings.c_str());
+    }
+
+  if (not opts.table)
+    return;
+  for (const auto& [key, value] : env.fields)
+    if (not value.empty())
+      std::cout << key << ": " << value << '\n';
+  std::cout << "cycle counter: " << clock
+            << (clock == "tsc" ? " (reference cycles)\n" : " (core cycles)\n");
+  if (opts.overhead == BenchOptions::Overhead::timer)
+    std::cout << "subtracted overhead: " << std::setprecision(3) << overhead.timer
+              << " cycles/batch (timer)\n";
+  else if (opts.overhead == BenchOptions::Overhead::loop)
+    std::cout << "subtracted overhead: " << std::setprecision(3) << overhead.timer
+              << " cycles/batch (timer), " << overhead.time_mean << " cycles/iteration (time_mean), "
+              << overhead.time_mean2 << " cycles/iteration (time_mean2)\n";
+  if (const FrequencyMonitor& frequency = frequency_monitor())
+    std::cout << "effective frequency: APERF/MPERF via " << frequency.name() << ", TSC at "
+              << std::setprecision(4) << frequency.tsc_frequency() << " GHz\n";
+  else
+    std::cout << "effective frequency: n/a (no access to the APERF/MPERF MSRs)\n";
+  if (opts.energy)
+    {
+      if (energy_meter())
+        std::cout << "energy: RAPL " << energy_meter().name()
+                  << " (whole package, includes loop overhead)\n";
+      else
+        std::cout << "energy: n/a (no readable RAPL counters)\n";
+    }
+  for (const std::string& warning : env.warnings)
+    std::cout << "\033[1;40;31mwarning:\033[0m " << warning << '\n';
+}
+
+/**
+ * Prints the two header lines of a table and returns their width.
+ */
 template <class B, std::size_t N>
-  void
+  std::size_t
   print_header(const cstr<N> &id_name)
   {
+    if (not bench_options().table)
+      return 0;
+    std::size_t column_width = 15 + 12 + 12 * bench_options().counters.size();
+    if (energy_meter())
+      column_width += 12;
+    if constexpr (has_traffic<B>)
+      column_width += 2 * 10;
+    if constexpr (has_elements<B>)
+      column_width += 12;
     std::cout << id_name;
     for (unsigned i = 0; i < B::info.size(); ++i)
-      std::cout << ' ' << std::setw(14) << B::info[i] << std::setw(12) << "Speedup";
+      {
+        std::cout << ' ' << std::setw(14) << B::info[i] << std::setw(12) << "Speedup";
+        for (const auto& counter : bench_options().counters)
+          std::cout << ' ' << std::setw(11) << counter.first.substr(0, 11);
+        if (energy_meter())
+          std::cout << std::setw(12) << "Energy";
+        if constexpr (has_traffic<B>)
+          std::cout << std::setw(10) << "Bandwidth" << std::setw(10) << "";
+        if constexpr (has_elements<B>)
+          std::cout << std::setw(12) << "Elements";
+      }
+    if (frequency_monitor())
+      std::cout << std::setw(8) << "GHz";
     std::cout << '\n';
 
     char pad[N] = {};
@@ -303,8 +2585,21 @@ template <class B, std::size_t N>
     pad[N - 1] = '\0';
     std::cout << pad;
     for (unsigned i = 0; i < B::info.size(); ++i)
-      std::cout << std::setw(15) << "[cycles/call]" << std::setw(12) << "[per value]";
+      {
+        std::cout << std::setw(15) << "[cycles/call]" << std::setw(12) << "[per value]";
+        for (int c = 0; c < perf_counters().size(); ++c)
+          std::cout << std::setw(12) << "[per call]";
+        if (energy_meter())
+          std::cout << std::setw(12) << "[nJ/value]";
+        if constexpr (has_traffic<B>)
+          std::cout << std::setw(10) << "[B/cycle]" << std::setw(10) << "[GB/s]";
+        if constexpr (has_elements<B>)
+          std::cout << std::setw(12) << "[per cycle]";
+      }
+    if (frequency_monitor())
+      std::cout << std::setw(8) << "[eff.]";
     std::cout << '\n';
+    return N - 1 + B::info.size() * column_width + (frequency_monitor() ? 8 : 0);
   }
 
 template <class T, class... ExtraFlags>
@@ -318,67 +2613,30 @@ template <class T, class... ExtraFlags>
     constexpr std::size_t type_field = value_type_field + 2 + abi_field;
     constexpr std::size_t id_size = type_field + (1 + ... + (1 + sizeof(ExtraFlags::name)));
     char id[id_size];
+
+    BenchCell cell = {id, value_type_name<T>(), "", ""};
+    cell.type.remove_prefix(cell.type.find_first_not_of(' '));
+    ([&](std::string_view flag) {
+      flag.remove_prefix(std::min(flag.size(), flag.find_first_not_of(' ')));
+      if (not cell.flags.empty())
+        cell.flags += ';';
+      cell.flags += flag;
+    }(ExtraFlags::name), ...);
+    if (not filter_accepts("type", std::string(cell.type))
+          or not filter_accepts("flags", cell.flags))
+      return;
+    print_preamble();
+
     std::memset(id, ' ', id_size - 1);
     id[id_size - 1] = '\0';
     std::memcpy(id + id_size/2 - 2, "TYPE", 4);
-    print_header<B>(id);
+    const std::size_t width = print_header<B>(id);
     std::memcpy(id + id_size/2 - 2, "    ", 4);
     char* const typestr = id;
     char* const abistr  = id + value_type_field + 2;
     id[value_type_field] = ',';
 
-    if constexpr (std::is_same_v<T, float>)
-      std::memcpy(typestr, " float", value_type_field);
-    else if constexpr (std::is_same_v<T, double>)
-      std::memcpy(typestr, "double", value_type_field);
-    else if constexpr (std::is_same_v<T, long double>)
-      std::memcpy(typestr, "ldoubl", value_type_field);
-#ifdef __STDCPP_FLOAT16_T__
-    else if constexpr (std::is_same_v<T, std::float16_t>)
-      std::memcpy(typestr, " flt16", value_type_field);
-#endif
-#ifdef __STDCPP_FLOAT32_T__
-    else if constexpr (std::is_same_v<T, std::float32_t>)
-      std::memcpy(typestr, " flt32", value_type_field);
-#endif
-#ifdef __STDCPP_FLOAT64_T__
-    else if constexpr (std::is_same_v<T, std::float64_t>)
-      std::memcpy(typestr, " flt64", value_type_field);
-#endif
-    else if constexpr (std::is_same_v<T, long long>)
-      std::memcpy(typestr, " llong", value_type_field);
-    else if constexpr (std::is_same_v<T, unsigned long long>)
-      std::memcpy(typestr, "ullong", value_type_field);
-    else if constexpr (std::is_same_v<T, long>)
-      std::memcpy(typestr, "  long", value_type_field);
-    else if constexpr (std::is_same_v<T, unsigned long>)
-      std::memcpy(typestr, " ulong", value_type_field);
-    else if constexpr (std::is_same_v<T, int>)
-      std::memcpy(typestr, "   int", value_type_field);
-    else if constexpr (std::is_same_v<T, unsigned>)
-      std::memcpy(typestr, "  uint", value_type_field);
-    else if constexpr (std::is_same_v<T, short>)
-      std::memcpy(typestr, " short", value_type_field);
-    else if constexpr (std::is_same_v<T, unsigned short>)
-      std::memcpy(typestr, "ushort", value_type_field);
-    else if constexpr (std::is_same_v<T, char>)
-      std::memcpy(typestr, "  char", value_type_field);
-    else if constexpr (std::is_same_v<T, signed char>)
-      std::memcpy(typestr, " schar", value_type_field);
-    else if constexpr (std::is_same_v<T, unsigned char>)
-      std::memcpy(typestr, " uchar", value_type_field);
-#if __cpp_char8_t >= 201811L
-    else if constexpr (std::is_same_v<T, char8_t>)
-      std::memcpy(typestr, " char8", value_type_field);
-#endif
-    else if constexpr (std::is_same_v<T, char16_t>)
-      std::memcpy(typestr, "char16", value_type_field);
-    else if constexpr (std::is_same_v<T, char32_t>)
-      std::memcpy(typestr, "char32", value_type_field);
-    else if constexpr (std::is_same_v<T, wchar_t>)
-      std::memcpy(typestr, " wchar", value_type_field);
-    else
-      std::memcpy(typestr, "??????", value_type_field);
+    std::memcpy(typestr, value_type_name<T>(), value_type_field);
 
     if constexpr (sizeof...(ExtraFlags) > 0)
       {
@@ -390,6 +2648,7 @@ template <class T, class... ExtraFlags>
       }
 
     auto set_abistr = [&](const char* str) {
+      cell.abi = *str ? str : "scalar";
       std::size_t len = std::strlen(str);
       if (len > abi_field)
         {
@@ -408,7 +2667,7 @@ template <class T, class... ExtraFlags>
         if constexpr (alignof(V16) == sizeof(V16))
           {
             set_abistr(("[[" + std::to_string(16 / sizeof(T)) + "]]").c_str());
-            return bench_lat_thr<V16, B>(id, ref0);
+            return bench_lat_thr<V16, B>(cell, ref0);
           }
         else
           return ref0;
@@ -419,7 +2678,7 @@ template <class T, class... ExtraFlags>
         if constexpr (alignof(V32) == sizeof(V32))
           {
             set_abistr(("[[" + std::to_string(32 / sizeof(T)) + "]]").c_str());
-            return bench_lat_thr<V32, B>(id, ref16);
+            return bench_lat_thr<V32, B>(cell, ref16);
           }
         else
 #endif
@@ -431,7 +2690,7 @@ template <class T, class... ExtraFlags>
         if constexpr (alignof(V64) == sizeof(V64))
           {
             set_abistr(("[[" + std::to_string(64 / sizeof(T)) + "]]").c_str());
-            return bench_lat_thr<V64, B>(id, ref32);
+            return bench_lat_thr<V64, B>(cell, ref32);
           }
         else
 #endif
@@ -440,9 +2699,9 @@ template <class T, class... ExtraFlags>
     };
 
     set_abistr("");
-    const auto ref0 = bench_lat_thr<T, B>(id);
+    const auto ref0 = bench_lat_thr<T, B>(cell);
     set_abistr("1");
-    const auto ref1 = bench_lat_thr<simd<T, 1>, B>(id, ref0);
+    const auto ref1 = bench_lat_thr<simd<T, 1>, B>(cell, ref0);
 
     constexpr bool use_gnu_reference
       = std::is_same_v<decltype(ref1), const NoRef> and alignof(V16) == sizeof(V16);
@@ -459,7 +2718,7 @@ template <class T, class... ExtraFlags>
         if constexpr (std::constructible_from<simd<T, N>>)
           {
             set_abistr(std::to_string(N).c_str());
-            bench_lat_thr<simd<T, N>, B>(id, ref);
+            bench_lat_thr<simd<T, N>, B>(cell, ref);
           }
       }(), ...);
     }(std::make_integer_sequence<int, 8>());
@@ -470,7 +2729,7 @@ template <class T, class... ExtraFlags>
         [&]<int... Is>(std::integer_sequence<int, Is...>) {
           ([&] {
             set_abistr(B::more_types[Is]);
-            bench_lat_thr<T, Benchmark<Is + 1, ExtraFlags...>>(id, ref);
+            bench_lat_thr<T, Benchmark<Is + 1, ExtraFlags...>>(cell, ref);
           }(), ...);
         }(std::make_integer_sequence<int, N>());
       }
@@ -478,23 +2737,45 @@ template <class T, class... ExtraFlags>
     if constexpr (not use_gnu_reference)
       bench_gnu_vectors(ref);
 
-    char sep[id_size + 2 * 15 + 2 * 12];
-    std::memset(sep, '-', sizeof(sep) - 1);
-    sep[sizeof(sep) - 1] = '\0';
-    std::cout << sep << std::endl;
+    if (bench_options().table)
+      std::cout << std::string(width, '-') << std::endl;
   }
 
+/**
+ * Delimit the timed code in the machine code, for codegen.py. The markers are
+ * 7-byte nops with a magic displacement (0x424b4200 = begin, 0x424b4500 =
+ * end). time_mean executes them once per batch, around the loop. time_mean2
+ * executes them once per timing run, around the kernel's own loop, so they also
+ * enclose the batch bookkeeping inlined from the collector; codegen.py drops its
+ * calls and cycle counter reads from the instruction mix. (Markers inside the
+ * loop would execute on every iteration.)
+ */
+[[gnu::always_inline]] inline void
+kernel_begin()
+{
+#ifdef __x86_64__
+  asm volatile("nopl 0x424b4200(%rax)");
+#endif
+}
+
+[[gnu::always_inline]] inline void
+kernel_end()
+{
+#ifdef __x86_64__
+  asm volatile("nopl 0x424b4500(%rax)");
+#endif
+}
+
 template <long Iterations = 50'000, int Retries = 20, class F>
   [[gnu::noinline]]
-  double
+  Measurement
   time_mean2(F&& fun)
   {
     struct {
-      //double mean = 0;
-      double minimum = std::numeric_limits<double>::max();
-      unsigned long tsc_start = 0;
-      int todo = Retries;
+      SampleCollector stats{Retries, Iterations, &TimingOverhead::time_mean2};
+      bool started = false;
       long it = 1;
+      long batch = 0;
 
       [[gnu::always_inline]]
       operator bool() &
@@ -502,56 +2783,86 @@ template <long Iterations = 50'000, int Retries = 20, class F>
         if (--it > 0) [[likely]]
           return true;
 
-        unsigned int tmp = 0;
-        const auto tsc_end = __rdtscp(&tmp);
-        if (todo < Retries) [[likely]]
-          {
-            const double elapsed = tsc_end - tsc_start;
-            const double one_mean = elapsed / Iterations;
-            //mean += one_mean / Retries;
-            if (one_mean < minimum)
-              {
-                minimum = one_mean;
-                todo = Retries;
-              }
-          }
-        if (todo) [[likely]]
+        if (started) [[likely]]
+          stats.stop_batch(batch);
+        if (not stats.done()) [[likely]]
           {
-            --todo;
-            it = Iterations + 1;
-            tsc_start = __rdtscp(&tmp);
+            started = true;
+            batch = stats.batch_size();
+            it = batch + 1;
+            stats.start_batch();
             return true;
           }
         return false;
       }
     } collector;
+    if (profiling) [[unlikely]]
+      profile_toggle(true);
+    kernel_begin();
     fun(collector);
-    return collector.minimum;
+    kernel_end();
+    if (profiling) [[unlikely]]
+      profile_toggle(false);
+    ++timing_log.timings;
+    return collector.stats.result();
   }
 
 template <long Iterations = 50'000, int Retries = 20, class F, class... Args>
-  double
+  Measurement
   time_mean(F&& fun, Args&&... args)
   {
-    double minimum = std::numeric_limits<double>::max();
-    for (int tries = 0; tries < Retries; ++tries)
+    SampleCollector stats(Retries, Iterations, &TimingOverhead::time_mean);
+    if (profiling) [[unlikely]]
+      profile_toggle(true);
+    do
       {
-        unsigned int tmp;
-        long i = Iterations;
-        const auto start = __rdtscp(&tmp);
+        const long batch = stats.batch_size();
+        long i = batch;
+        stats.start_batch();
+        kernel_begin();
         for (; i; --i)
           fun(std::forward<Args>(args)...);
-        const auto end = __rdtscp(&tmp);
-        const double elapsed = end - start;
-        if (elapsed < minimum)
-          {
-            minimum = elapsed;
-            tries = -1;
-          }
+        kernel_end();
+        stats.stop_batch(batch);
       }
-    return minimum / Iterations;
+    while (not stats.done());
+    if (profiling) [[unlikely]]
+      profile_toggle(false);
+    ++timing_log.timings;
+    return stats.result();
   }
 
+inline const TimingOverhead&
+timing_overhead()
+{
+  static constexpr TimingOverhead none = {};
+  // the timing runs below must not subtract the overhead they measure
+  static thread_local bool measuring = false;
+  if (measuring or bench_options().overhead == BenchOptions::Overhead::none)
+    return none;
+  static const TimingOverhead overhead = [] {
+    measuring = true;
+    const TimingLog log = timing_log;
+    TimingOverhead r;
+    r.timer = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < 1000; ++i)
+      {
+        const unsigned long t0 = cycle_clock().now();
+        const unsigned long t1 = cycle_clock().now();
+        r.timer = std::min(r.timer, double(t1 - t0));
+      }
+    r.time_mean = time_mean([] { asm volatile(""); }).median;
+    r.time_mean2 = time_mean2([](auto& need_more) {
+                     while (need_more)
+                       asm volatile("");
+                   }).median;
+    timing_log = log;
+    measuring = false;
+    return r;
+  }();
+  return overhead;
+}
+
 template <typename T>
   [[gnu::always_inline]] inline void
   fake_modify_one(T& x)
@@ -655,17 +2966,21 @@ template <typename T, std::size_t N>
   using carray = T[N];
 
 template <long Iterations = 50'000, int Retries = 20, typename T, std::size_t N>
-  double
+  Measurement
   time_latency(carray<T, N>& data, auto&& process_one)
   {
     for (auto& x : data)
       fake_modify_one(x);
 
-    const double dt = time_mean<Iterations, Retries>([&] [[gnu::always_inline]] {
-                        data[0] = process_one(std::false_type(), data[0]);
-                      }) - time_mean<Iterations, Retries>([&] [[gnu::always_inline]] {
-                             data[0] = process_one(std::true_type(), data[0]);
-                           });
+    const Measurement real = time_mean<Iterations, Retries>([&] [[gnu::always_inline]] {
+                               data[0] = process_one(std::false_type(), data[0]);
+                             });
+    // the profile (BENCH_PROFILE) only covers the real run, the result is unused
+    if (profiling)
+      return real;
+    const Measurement dt = real - time_mean<Iterations, Retries>([&] [[gnu::always_inline]] {
+                                    data[0] = process_one(std::true_type(), data[0]);
+                                  });
 
     if (dt >= 0.98)
       return dt;
@@ -674,39 +2989,166 @@ template <long Iterations = 50'000, int Retries = 20, typename T, std::size_t N>
     std::abort();
   }
 
+/**
+ * Least-squares fit of the measurements \p y at the chain lengths \p x to
+ * y = intercept + slope × x, applied to each statistic. The result holds the
+ * slopes, the 95% confidence interval of the slope of the medians, the
+ * intercept of the estimator and the goodness of fit (R²) of the medians.
+ */
+template <std::size_t N>
+  [[gnu::noinline]] Measurement
+  fit_chain_lengths(const std::array<int, N>& x, const std::array<Measurement, N>& y)
+  {
+    static_assert(N >= 3);
+    double x_mean = 0;
+    for (int xi : x)
+      x_mean += double(xi) / N;
+    double sxx = 0;
+    for (int xi : x)
+      sxx += (xi - x_mean) * (xi - x_mean);
+    // returns {intercept, slope}
+    auto fit = [&](auto&& get) {
+      double y_mean = 0, sxy = 0;
+      for (std::size_t i = 0; i < N; ++i)
+        y_mean += get(y[i]) / N;
+      for (std::size_t i = 0; i < N; ++i)
+        sxy += (x[i] - x_mean) * (get(y[i]) - y_mean);
+      const double slope = sxy / sxx;
+      return std::pair(y_mean - slope * x_mean, slope);
+    };
+
+    Measurement r;
+    const auto [intercept, median_slope]
+      = fit([](const Measurement& m) { return m.median; });
+    const auto [value_intercept, value_slope]
+      = fit([](const Measurement& m) { return m.value; });
+    r.median = median_slope;
+    r.value = value_slope;
+    r.fit_intercept = value_intercept;
+    r.min = fit([](const Measurement& m) { return m.min; }).second;
+    r.p90 = fit([](const Measurement& m) { return m.p90; }).second;
+    r.overhead = fit([](const Measurement& m) { return m.overhead; }).second;
+    r.raw_median = fit([](const Measurement& m) { return m.raw_median; }).second;
+    r.energy = fit([](const Measurement& m) { return m.energy; }).second;
+    r.energy_core = fit([](const Measurement& m) { return m.energy_core; }).second;
+    r.mad = std::numeric_limits<double>::quiet_NaN();
+    for (int c = 0; c < max_counters; ++c)
+      r.counters[c] = fit([c](const Measurement& m) { return m.counters[c]; }).second;
+    r.samples = y[0].samples;
+    for (const Measurement& m : y)
+      r.samples = std::min(r.samples, m.samples);
+
+    double ssr = 0, sst = 0, y_mean = 0;
+    for (const Measurement& m : y)
+      y_mean += m.median / N;
+    for (std::size_t i = 0; i < N; ++i)
+      {
+        const double residual = y[i].median - (intercept + r.median * x[i]);
+        ssr += residual * residual;
+        sst += (y[i].median - y_mean) * (y[i].median - y_mean);
+      }
+    r.fit_r2 = sst > 0 ? 1 - ssr / sst : 1;
+    // Student's t quantile (97.5%) for N - 2 degrees of freedom
+    constexpr double t975[] = {12.71, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306};
+    const double t = N - 2 <= std::size(t975) ? t975[N - 3] : 1.96;
+    const double half_width = t * std::sqrt(ssr / (N - 2) / sxx);
+    r.ci_low = r.median - half_width;
+    r.ci_high = r.median + half_width;
+    return r;
+  }
+
+/**
+ * Latency of \p op, i.e. the cost of one more dependent call in a chain of
+ * `x = op(x)`. The chains of ChainLengths calls are timed separately and a
+ * line is fitted through the cycles per chain: the slope is the latency, the
+ * intercept the cost of the loop and anything else not part of the chain (see
+ * fit_chain_lengths). Unlike hand-unrolled chains scaled by 1/n, this does not
+ * attribute the loop overhead to the operation, and a low R² exposes chains
+ * the compiler reordered or fused.
+ *
+ * The chains are unrolled at compile time, so \p op is inlined
+ * sum(ChainLengths) times.
+ */
+template <long Iterations = 50'000, int Retries = 20, int... ChainLengths>
+  Measurement
+  time_latency_fit(auto& x, auto&& op)
+  {
+    if constexpr (sizeof...(ChainLengths) == 0)
+      return time_latency_fit<Iterations, Retries, 1, 2, 4, 8, 16>(x, op);
+    else
+      {
+        const std::array<Measurement, sizeof...(ChainLengths)> chains = {
+          time_mean<std::max(1l, Iterations / ChainLengths), Retries>([&] {
+            [&]<int... Is>(std::integer_sequence<int, Is...>) {
+              ((x = op(x), void(Is)), ...);
+            }(std::make_integer_sequence<int, ChainLengths>());
+            fake_read(x);
+          })...
+        };
+        return fit_chain_lengths(std::array{ChainLengths...}, chains);
+      }
+  }
+
+/**
+ * Cycles per call of \p process_one with \p Chains independent dependency
+ * chains, initialized from \p init_data (repeated cyclically).
+ */
+template <long Iterations, int Retries, std::size_t Chains, typename T, std::size_t N>
+  Measurement
+  time_throughput_chains(carray<T, N>& init_data, auto&& process_one)
+  {
+    const Measurement real = time_mean2<Iterations, Retries>([&](auto& need_more) {
+      [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+        T data[Chains] = {init_data[Is % N]...};
+        while (need_more)
+          {
+            //fake_read(data[Is]...);
+            ((data[Is] = process_one(std::false_type(), data[Is])), ...);
+          }
+        fake_read(data[Is]...);
+      }(std::make_index_sequence<Chains>());
+    });
+    // the profile (BENCH_PROFILE) only covers the real run, the result is unused
+    if (profiling)
+      return real;
+    return (real - time_mean2<Iterations, Retries>([&](auto& need_more) {
+                   [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+                     T data[Chains] = {init_data[Is % N]...};
+                     while (need_more)
+                       {
+                         //fake_read(data[Is]...);
+                         ((data[Is] = process_one(std::true_type(), data[Is])), ...);
+                       }
+                     fake_read(data[Is]...);
+                   }(std::make_index_sequence<Chains>());
+                 }))
+             / Chains;
+  }
+
+/**
+ * Throughput of \p process_one with N independent chains.
+ *
+ * With -DBENCH_ILP_SWEEP the throughput is additionally measured for each of
+ * ilp_chain_counts and stored in Measurement::ilp_curve. This shows how many
+ * operations need to be in flight to reach peak throughput and where register
+ * spilling makes it drop again (see ilp_knee_and_spill). Since every chain
+ * count is a separate instantiation with process_one inlined that many times,
+ * the sweep multiplies compile time and is therefore opt-in.
+ */
 template <long Iterations = 50'000, int Retries = 20, typename T, std::size_t N>
-  double
+  Measurement
   time_throughput(carray<T, N>& init_data, auto&& process_one)
   {
     for (auto& x : init_data)
       fake_modify_one(x);
 
-    const double dt
-      = (time_mean2<Iterations, Retries>([&](auto& need_more) {
-           [&]<std::size_t... Is>(std::index_sequence<Is...>) {
-             T data[N];
-             std::ranges::copy(init_data, data);
-             while (need_more)
-               {
-                 //fake_read(data[Is]...);
-                 ((data[Is] = process_one(std::false_type(), data[Is])), ...);
-               }
-             fake_read(data[Is]...);
-           }(std::make_index_sequence<N>());
-         }) - time_mean2<Iterations, Retries>([&](auto& need_more) {
-                [&]<std::size_t... Is>(std::index_sequence<Is...>) {
-                  T data[N];
-                  std::ranges::copy(init_data, data);
-                  while (need_more)
-                    {
-                      //fake_read(data[Is]...);
-                      ((data[Is] = process_one(std::true_type(), data[Is])), ...);
-                    }
-                  fake_read(data[Is]...);
-                }(std::make_index_sequence<N>());
-              }))
-          / N;
-
+    Measurement dt = time_throughput_chains<Iterations, Retries, N>(init_data, process_one);
+#ifdef BENCH_ILP_SWEEP
+    [&]<std::size_t... Ks>(std::index_sequence<Ks...>) {
+      ((dt.ilp_curve[Ks] = time_throughput_chains<Iterations, Retries, ilp_chain_counts[Ks]>(
+                             init_data, process_one).value), ...);
+    }(std::make_index_sequence<ilp_chain_counts.size()>());
+#endif
     return dt;
   }
 
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-3.0-or-later
+# Copyright © 2026      GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+#                       Matthias Kretz <m.kretz@gsi.de>
+
+"""Instruction mix and code size of the timed kernels in a benchmark binary.
+
+  codegen.py [--filter <glob>] [--all] <binary>...
+
+time_mean and time_mean2 (bench.h) enclose the timed code in marker nops. This
+script disassembles the binary with objdump, finds the code between the
+markers and reports per kernel (without the calls and cycle counter reads of
+the timing harness, which time_mean2's markers enclose as well):
+
+  bytes    code size between the markers
+  insns    number of instructions
+  512/256/128
+           instructions operating on zmm/ymm/xmm registers as vectors
+  sFP      scalar floating-point instructions (…ss/…sd)
+  lane     element inserts/extracts and moves between vector and GPRs
+  gpr      instructions not touching vector registers (incl. loop control)
+  spill/reload
+           stores/loads of registers to/from the stack
+  calls    call instructions
+  scalar%  share of sFP and lane in all vector register instructions
+
+Kernels of vector types (simd<T, N> with N > 1 or GNU vectors) are flagged
+SCALARIZED if they call scalar math functions or if more than half of their
+(and at least 4) vector register instructions are scalar. This catches e.g.
+per-element fallbacks of math functions or fixed_size simds.
+
+--filter only shows kernels whose (shortened) name matches the glob, e.g.
+'*F_sin*_VecBuiltin<32>*'. --all includes the harness' own timing loops.
+"""
+
+import argparse
+import fnmatch
+import re
+import subprocess
+import sys
+
+BEGIN, END = "0x424b4200(%rax)", "0x424b4500(%rax)"
+NAMESPACES = ["std::experimental::parallelism_v2::", "simd_abi::", "std::"]
+LANE = re.compile(r"v?(p?extr|p?insr|extract|insert)\w*")
+GPR_MOVE = re.compile(r"v?mov[dq]")
+SCALAR_FP = re.compile(r"v?[a-z0-9]*s[sd]")
+CALLEE = re.compile(r"<([^+>]*)(\+0x[0-9a-f]+)?>")
+# the batch bookkeeping of time_mean2's collector
+HARNESS = re.compile(r"(SampleCollector|CycleClock|cycle_clock|profile_toggle|monotonic_ns)\b")
+HARNESS_INSNS = ("rdtsc", "rdtscp", "rdpmc", "lfence")
+
+
+def shorten(name):
+    for ns in NAMESPACES:
+        name = name.replace(ns, "")
+    return name
+
+
+def cell_name(function):
+    """The Benchmark<...>::run<T>() part, the kernel lambda and the timing function."""
+    m = re.search(r"Benchmark<[^:]*>::run<.*?>\(\)(::\{lambda[^}]*\}#?\d*)*", function)
+    if not m:
+        return shorten(function)
+    timer = re.match(r"Measurement (time_mean2?<\d+)l", function)
+    return shorten(m.group(0)) + (f" [{timer.group(1)}>]" if timer else "")
+
+
+def is_vector(name):
+    m = re.search(r"::run<(.*)>\(\)", name)
+    t = m.group(1) if m else ""
+    return ("__vector(" in t and "__vector(1)" not in t) or (
+        "simd<" in t and "_Scalar" not in t and "_Fixed<1>" not in t)
+
+
+def disassemble(binary):
+    """Yields (function, [(address, mnemonic, operands)]) for functions with markers."""
+    out = subprocess.run(["objdump", "-d", "-C", "--no-show-raw-insn", "-M", "att", binary],
+                         check=True, capture_output=True, text=True).stdout
+    function, insns = None, []
+    for line in out.splitlines():
+        m = re.match(r"^[0-9a-f]+ <(.*)>:$", line)
+        if m:
+            if function and any(BEGIN in i[2] for i in insns):
+                yield function, insns
+            function, insns = m.group(1), []
+            continue
+        m = re.match(r"^\s+([0-9a-f]+):\s+(\S+)\s*(.*)$", line)
+        if m and function:
+            insns.append((int(m.group(1), 16), m.group(2), m.group(3)))
+    if function and any(BEGIN in i[2] for i in insns):
+        yield function, insns
+
+
+def kernels(insns):
+    """Splits insns into the instruction lists between begin and end markers."""
+    kernel = None
+    for address, mnemonic, operands in insns:
+        if BEGIN in operands:
+            kernel = [(address + 7, "", "")]
+        elif END in operands and kernel is not None:
+            yield kernel[1:], address - kernel[0][0]
+            kernel = None
+        elif kernel is not None:
+            kernel.append((address, mnemonic, operands))
+
+
+def analyze(kernel):
+    c = dict(insns=0, v512=0, v256=0, v128=0, sfp=0, lane=0, gpr=0, spill=0, reload=0,
+             calls=0)
+    callees = set()
+    for _, mnemonic, operands in kernel:
+        if mnemonic.startswith("nop") or mnemonic in ("xchg", "data16", "cs"):
+            continue
+        if mnemonic in HARNESS_INSNS or (mnemonic.startswith("call")
+                                         and HARNESS.search(operands)):
+            continue
+        c["insns"] += 1
+        vreg = re.search(r"%([xyz])mm", operands)
+        if mnemonic.startswith("call"):
+            c["calls"] += 1
+            m = CALLEE.search(operands)
+            if m:
+                callees.add(m.group(1).removesuffix("@plt"))
+        elif vreg and (LANE.fullmatch(mnemonic) or (GPR_MOVE.fullmatch(mnemonic)
+                                                   and re.search(r"%[re]\w+\b", operands))):
+            c["lane"] += 1
+        elif vreg and SCALAR_FP.fullmatch(mnemonic) and not mnemonic.startswith(("p", "vp")):
+            c["sfp"] += 1
+        elif vreg:
+            c[{"z": "v512", "y": "v256", "x": "v128"}[
+                max(re.findall(r"%([xyz])mm", operands), key="xyz".index)]] += 1
+        else:
+            c["gpr"] += 1
+        if "mov" in mnemonic and re.search(r"\(%[re](sp|bp)\)", operands):
+            # AT&T syntax: the destination is the last operand
+            if re.search(r"\(%[re](sp|bp)\)$", operands.split("#")[0].strip()):
+                c["spill"] += 1
+            else:
+                c["reload"] += 1
+    vector_insns = c["v512"] + c["v256"] + c["v128"] + c["sfp"] + c["lane"]
+    c["scalar"] = (c["sfp"] + c["lane"]) / vector_insns if vector_insns else 0
+    return c, callees
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--filter", help="glob for the kernel names to show")
+    parser.add_argument("--all", action="store_true",
+                        help="include kernels outside of Benchmark<...>::run")
+    parser.add_argument("binaries", nargs="+")
+    args = parser.parse_args()
+
+    flagged = 0
+    for binary in args.binaries:
+        print(f"{binary}:")
+        print(f"{'':6}{'bytes':>7}{'insns':>7}{'512':>6}{'256':>6}{'128':>6}{'sFP':>6}"
+              f"{'lane':>6}{'gpr':>6}{'spill':>7}{'reload':>7}{'calls':>6}{'scalar%':>8}")
+        for function, insns in disassemble(binary):
+            if not args.all and "Benchmark<" not in function:
+                continue
+            name = cell_name(function)
+            if args.filter and not fnmatch.fnmatchcase(name, args.filter):
+                continue
+            print(f"  {name}")
+            for kernel, size in kernels(insns):
+                c, callees = analyze(kernel)
+                # C functions such as sinf; vector variants are named _ZGV…
+                scalar_math = sorted(f for f in callees if re.fullmatch(r"[a-z][a-z0-9_]*", f))
+                flags = []
+                if is_vector(function) and (scalar_math or (
+                        c["scalar"] > 0.5 and c["sfp"] + c["lane"] >= 4)):
+                    flags.append("SCALARIZED")
+                    flagged += 1
+                if scalar_math:
+                    flags.append("calls " + ",".join(scalar_math))
+                print(f"{'':6}{size:7}{c['insns']:7}{c['v512']:6}{c['v256']:6}{c['v128']:6}"
+                      f"{c['sfp']:6}{c['lane']:6}{c['gpr']:6}{c['spill']:7}{c['reload']:7}"
+                      f"{c['calls']:6}{c['scalar']:8.0%}  {' '.join(flags)}")
+    if flagged:
+        print(f"\n{flagged} kernels of vector types look scalarized")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
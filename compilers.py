@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-3.0-or-later
+# Copyright © 2026      GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+#                       Matthias Kretz <m.kretz@gsi.de>
+
+"""Side-by-side comparison of the same benchmarks built with different compilers.
+
+  compilers.py [--reference <glob>] <file.jsonl>...
+
+Reads result files of one or more compilers, e.g. the data/*.jsonl files of
+`make COMPILERS="g++-13 clang++-18" benchmark` or of `run.sh --cxx=... --cxx=...`.
+Files are grouped by benchmark and compiler flags (as recorded in the
+environment record), and within each group the compilers (the 'compiler'
+field, e.g. 'GCC 14.1.0') are printed side by side. Every cell shows the
+cycles/call and the speedup against the reference compiler, which is the
+first compiler matching --reference (default: the compiler of the first file).
+Speedups are colored like the table of the benchmarks themselves, but only if
+the confidence intervals of both medians do not overlap.
+"""
+
+import argparse
+import fnmatch
+import json
+import sys
+
+from resultdb import is_result
+
+GREEN = "\033[1;40;32m"
+DGREEN = "\033[0;40;32m"
+RED = "\033[1;40;31m"
+NORMAL = "\033[0m"
+
+
+def load(paths):
+    """Returns {(benchmark, cxxflags): {compiler: [records]}} and the compilers in order."""
+    groups, compilers = {}, []
+    for path in paths:
+        env, rows = {}, []
+        with open(path) as f:
+            for line in filter(str.strip, f):
+                r = json.loads(line)
+                if r.get("record") == "environment":
+                    env = r
+                elif is_result(r):
+                    rows.append(r)
+        if not rows:
+            continue
+        compiler = env.get("compiler") or path
+        flags = env.get("cxxflags") or path
+        if compiler not in compilers:
+            compilers.append(compiler)
+        groups.setdefault((rows[0]["benchmark"], flags), {})[compiler] = rows
+    return groups, compilers
+
+
+def colored(speedup, ref, r, use_color):
+    text = f"{speedup:12.3g}"
+    if not use_color or None in (ref.get("ci_low"), ref.get("ci_high"), r.get("ci_low"),
+                                 r.get("ci_high")):
+        return text
+    if r["ci_low"] <= ref["ci_high"] and ref["ci_low"] <= r["ci_high"]:
+        return text
+    # the thresholds of the benchmark tables (report_cell in bench.h): red only
+    # below 0.95, no color between that and 1
+    if speedup >= 1.1:
+        return GREEN + text + NORMAL
+    if speedup > 1:
+        return DGREEN + text + NORMAL
+    if speedup < 0.95:
+        return RED + text + NORMAL
+    return text
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--reference", help="glob matching the reference compiler")
+    parser.add_argument("files", nargs="+")
+    args = parser.parse_args()
+    groups, compilers = load(args.files)
+    if len(compilers) < 2:
+        sys.exit(f"need results of at least two compilers, found {compilers}")
+    reference = compilers[0]
+    if args.reference:
+        matches = [c for c in compilers if fnmatch.fnmatchcase(c, args.reference)]
+        if not matches:
+            sys.exit(f"no compiler matches '{args.reference}' (have {compilers})")
+        reference = matches[0]
+    others = [c for c in compilers if c != reference]
+    use_color = sys.stdout.isatty()
+
+    for (benchmark, flags), by_compiler in sorted(groups.items()):
+        ref_rows = by_compiler.get(reference)
+        if ref_rows is None or len(by_compiler) < 2:
+            continue
+        present = [c for c in others if c in by_compiler]
+        print(f"\n{benchmark}: {flags}")
+        print(f"{'':44}{reference:>15}"
+              + "".join(f"{c[:27]:>27}" for c in present))
+        cells = {c: {(r["type"], r["abi"], r["flags"], r["column"]): r for r in by_compiler[c]}
+                 for c in present}
+        for ref in ref_rows:
+            key = (ref["type"], ref["abi"], ref["flags"], ref["column"])
+            label = f"{ref['type']}, {ref['abi']}"
+            line = f"{label[:18]:18} {ref['flags'][:14]:14} {ref['column'][:10]:>10}"
+            line += f"{ref['cycles_per_call']:15.3g}" if ref["cycles_per_call"] is not None \
+                else f"{'n/a':>15}"
+            for c in present:
+                r = cells[c].get(key)
+                if r is None or not r["cycles_per_call"] or ref["cycles_per_call"] is None:
+                    line += f"{'n/a':>27}"
+                    continue
+                speedup = ref["cycles_per_call"] / r["cycles_per_call"]
+                line += f"{r['cycles_per_call']:15.3g}" + colored(speedup, ref, r, use_color)
+            print(line)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,275 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/* Copyright © 2026      GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                       Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#include "bench.h"
+#include <random>
+
+constexpr size_t KiB = 1024;
+constexpr size_t MiB = 1024 * KiB;
+
+/**
+ * The tables of all index patterns, zero-initialized (per thread).
+ */
+char*
+arena()
+{ return thread_buffer(256 * MiB); }
+
+/**
+ * An all-zero table as large as the arena, which is never written: the Latency
+ * column gathers from it, so that the gathered values can be added to the
+ * indices.
+ */
+const char*
+zeros()
+{
+  static const char* const table = alloc_buffer(256 * MiB);
+  return table;
+}
+
+/*
+ * The index patterns: index(k, n, gen) is the k-th index into a table of
+ * n = bytes / sizeof(T) elements.
+ */
+struct Contiguous
+{
+  static constexpr char name[] = " contiguous";
+  static constexpr size_t bytes = 16 * KiB;
+
+  static size_t
+  index(size_t k, size_t n, std::mt19937&)
+  { return k % n; }
+};
+
+struct Strided
+{
+  static constexpr char name[] = " stride 64B";
+  static constexpr size_t bytes = 256 * KiB;
+
+  template <class T>
+    static size_t
+    index(size_t k, size_t n, std::mt19937&)
+    { return k * (64 / sizeof(T)) % n; }
+};
+
+template <size_t Bytes>
+  struct Random
+  {
+    static constexpr size_t bytes = Bytes;
+
+    static size_t
+    index(size_t, size_t n, std::mt19937& gen)
+    { return std::uniform_int_distribution<size_t>(0, n - 1)(gen); }
+  };
+
+struct RandomL1 : Random<16 * KiB>
+{ static constexpr char name[] = " random L1"; };
+
+struct RandomL2 : Random<256 * KiB>
+{ static constexpr char name[] = " random L2"; };
+
+struct RandomL3 : Random<8 * MiB>
+{ static constexpr char name[] = " random L3"; };
+
+struct RandomDRAM : Random<256 * MiB>
+{ static constexpr char name[] = "random DRAM"; };
+
+struct Duplicates
+{
+  static constexpr char name[] = " duplicates";
+  static constexpr size_t bytes = 16 * KiB;
+
+  // 4 distinct indices: most vectors contain repeated indices
+  static size_t
+  index(size_t, size_t, std::mt19937& gen)
+  { return gen() % 4; }
+};
+
+template <class T>
+  using index_t = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+
+/**
+ * The vector of indices for gathering a V: a vector builtin, simd, or scalar
+ * of index_t with the same width as V.
+ */
+template <class V>
+  auto
+  index_vector_impl()
+  {
+    using U = index_t<value_type_t<V>>;
+    if constexpr (std::is_arithmetic_v<V>)
+      return U();
+    else if constexpr (vec_builtin<V>)
+      return vec_builtin_type_bytes<U, sizeof(V)>();
+#if USE_STD_SIMD
+    else
+      return std::rebind_simd_t<U, V>();
+#else
+    else
+      return stdx::rebind_simd_t<U, V>();
+#endif
+  }
+
+template <class V>
+  using index_vector_t = decltype(index_vector_impl<V>());
+
+template <class IV>
+  [[gnu::always_inline]] inline IV
+  load_indices(const value_type_t<IV>* ptr)
+  {
+    if constexpr (std::is_arithmetic_v<IV>)
+      return *ptr;
+    else if constexpr (vec_builtin<IV>)
+      {
+        IV r;
+        std::memcpy(&r, ptr, sizeof(r));
+        return r;
+      }
+#if USE_STD_SIMD
+    else
+      return IV(ptr);
+#else
+    else
+      return IV(ptr, stdx::element_aligned);
+#endif
+  }
+
+/**
+ * \p x converted element-wise to the index vector IV.
+ */
+template <class IV, class V>
+  [[gnu::always_inline]] inline IV
+  to_indices(const V& x)
+  {
+    if constexpr (std::is_arithmetic_v<V>)
+      return IV(x);
+    else if constexpr (vec_builtin<V>)
+      return __builtin_convertvector(x, IV);
+#if USE_STD_SIMD
+    else
+      return IV(x);
+#else
+    else
+      return stdx::static_simd_cast<IV>(x);
+#endif
+  }
+
+/**
+ * data[iv[i]] for every element: an element loop for vector builtins and the
+ * generator constructor for simd.
+ */
+template <class V, class IV>
+  [[gnu::always_inline]] inline V
+  gather(const value_type_t<V>* data, const IV& iv)
+  {
+    if constexpr (std::is_arithmetic_v<V>)
+      return data[iv];
+    else if constexpr (vec_builtin<V>)
+      return [&]<int... Is>(std::integer_sequence<int, Is...>) {
+        return V{data[iv[Is]]...};
+      }(std::make_integer_sequence<int, size_v<V>>());
+    else
+      return V([&](auto i) { return data[iv[i]]; });
+  }
+
+template <class V, class IV>
+  [[gnu::always_inline]] inline void
+  scatter(value_type_t<V>* data, const IV& iv, const V& x)
+  {
+    if constexpr (std::is_arithmetic_v<V>)
+      data[iv] = x;
+    else
+      for (int i = 0; i < size_v<V>; ++i)
+        data[iv[i]] = x[i];
+  }
+
+template <int Special, class Pattern>
+  struct Benchmark<Special, Pattern>
+  {
+    static constexpr Info<3> info = {"Latency", "Gather", "Scatter"};
+
+    // elements per cycle for the throughput columns
+    static constexpr std::array<double, 3> elements = {0, 1, 1};
+
+    // the vector builtins are the reference
+    template <typename T>
+      static constexpr bool accept = size_v<T> > 1;
+
+    template <class V>
+      static Times<3>
+      run()
+      {
+        using T = value_type_t<V>;
+        using IV = index_vector_t<V>;
+        using U = value_type_t<IV>;
+        constexpr size_t W = size_v<V>;
+
+        const size_t n = Pattern::bytes / sizeof(T);
+        // enough indices to touch the whole table, cycled through with a mask
+        const size_t nidx = std::bit_ceil(std::clamp(n, size_t(1024), size_t(1) << 20));
+        std::vector<U> idx(nidx + W);
+        std::mt19937 gen(1);
+        for (size_t k = 0; k < idx.size(); ++k)
+          {
+            if constexpr (requires { Pattern::template index<T>(k, n, gen); })
+              idx[k] = Pattern::template index<T>(k, n, gen);
+            else
+              idx[k] = Pattern::index(k, n, gen);
+          }
+        T* const data = reinterpret_cast<T*>(arena());
+        // all zero: added to the next indices, this makes them depend on the
+        // gathered values
+        const T* const zero = reinterpret_cast<const T*>(zeros());
+
+        return {
+          time_mean2<100'000>([&](auto& need_more) {
+            V dep = V();
+            while (need_more)
+              {
+                const size_t i = (need_more.it * W) & (nidx - 1);
+                dep = gather<V>(zero, load_indices<IV>(&idx[i]) + to_indices<IV>(dep));
+              }
+            fake_read(dep);
+          }),
+          time_mean2<100'000>([&](auto& need_more) {
+            while (need_more)
+              {
+                const size_t i = (need_more.it * W) & (nidx - 1);
+                fake_read(gather<V>(data, load_indices<IV>(&idx[i])));
+              }
+          }),
+          time_mean2<100'000>([&](auto& need_more) {
+            V x = V();
+            fake_modify(x);
+            while (need_more)
+              {
+                const size_t i = (need_more.it * W) & (nidx - 1);
+                scatter<V>(data, load_indices<IV>(&idx[i]), x);
+              }
+          })
+        };
+      }
+  };
+
+template <class T>
+  void
+  bench_patterns()
+  {
+    bench_all<T, Contiguous>();
+    bench_all<T, Strided>();
+    bench_all<T, RandomL1>();
+    bench_all<T, RandomL2>();
+    bench_all<T, RandomL3>();
+    bench_all<T, RandomDRAM>();
+    bench_all<T, Duplicates>();
+  }
+
+int
+main()
+{
+  bench_patterns<int>();
+  bench_patterns<long long>();
+  bench_patterns<float>();
+  bench_patterns<double>();
+}
@@ -13,7 +13,7 @@ template <int Special>
     static constexpr Info<2> info = {"Latency", "Throughput"};
 
     template <bool Latency, class T>
-      static double
+      static Measurement
       do_benchmark()
       {
         T a = T() + 0x1.fe8222p-10f;
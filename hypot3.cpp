@@ -198,7 +198,7 @@ template <int Special>
       }
 
     template <bool Latency, class T>
-      static double
+      static Measurement
       do_benchmark()
       {
         T a = T() + 0x1.fe8222p-10f;
@@ -0,0 +1,161 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/* Copyright © 2026      GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                       Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#include "bench.h"
+
+alignas(64) char mem[64 * 64] = {};
+
+struct ElementAligned
+{
+  static constexpr char name[] = "element_aligned";
+  static constexpr bool aligned = false;
+  static constexpr auto flags
+#if USE_STD_SIMD
+    = std::simd_flag_default;
+#else
+    = stdx::element_aligned;
+#endif
+};
+
+struct VectorAligned
+{
+  static constexpr char name[] = " vector_aligned";
+  static constexpr bool aligned = true;
+  static constexpr auto flags
+#if USE_STD_SIMD
+    = std::simd_flag_aligned;
+#else
+    = stdx::vector_aligned;
+#endif
+};
+
+/**
+ * Loads a V from mem + offset via copy_from or (if \p Ctor) the load
+ * constructor. Vector builtins use an aligned dereference or memcpy.
+ */
+template <typename V, class Flags, bool Ctor>
+  [[gnu::always_inline]] inline V
+  load(size_t offset)
+  {
+    using Mem = value_type_t<V>;
+    const Mem* ptr = reinterpret_cast<const Mem*>(mem + offset);
+    // mem could have changed: load again on every call
+    asm volatile("" : "+m"(mem));
+    V x;
+    if constexpr (vec_builtin<V> and Flags::aligned)
+      x = *reinterpret_cast<const V*>(ptr);
+    else if constexpr (vec_builtin<V>)
+      std::memcpy(&x, ptr, sizeof(V));
+    else if constexpr (Ctor)
+      x = V(ptr, Flags::flags);
+    else
+      x.copy_from(ptr, Flags::flags);
+    return x;
+  }
+
+/**
+ * fake_read, but from registers only: fake_read lets vectors smaller than 16
+ * bytes be a memory operand, which would elide the load.
+ */
+template <typename V>
+  [[gnu::always_inline]] inline void
+  use(const V& x)
+  {
+    if constexpr (sizeof(V) < 16)
+      asm volatile("" ::"x,r"(std::bit_cast<vec_builtin_type_bytes<char, sizeof(V)>>(x)));
+    else
+      fake_read(x);
+  }
+
+/**
+ * The lowest byte of element 0, to make the address of the next load depend on
+ * the loaded value. mem is all zeros, so this is always 0. \p x is forced into
+ * a vector register first, as otherwise a byte load would suffice.
+ */
+template <typename V>
+  [[gnu::always_inline]] inline size_t
+  first_byte(V x)
+  {
+    using T = value_type_t<V>;
+    if constexpr (sizeof(V) < 16)
+      {
+        auto v = std::bit_cast<vec_builtin_type_bytes<char, sizeof(V)>>(x);
+        asm("" : "+x"(v));
+        x = std::bit_cast<V>(v);
+      }
+    else
+      fake_modify(x);
+    return std::bit_cast<std::array<unsigned char, sizeof(T)>>(T(x[0]))[0];
+  }
+
+template <int Special, class Flags>
+  struct Benchmark<Special, Flags>
+  {
+    static constexpr Info<3> info = {"Latency", "copy_from", "load ctor"};
+
+    // the vector builtins are the reference
+    template <typename T>
+      static constexpr bool accept = size_v<T> > 1;
+
+    template <class V>
+      static Times<3>
+      run()
+      {
+        auto throughput = [](auto ctor) {
+          constexpr bool Ctor = decltype(ctor)::value;
+          return 0.0625 * time_mean2<400'000>([](auto& need_more) {
+                            while (need_more)
+                              {
+                                use(load<V, Flags, Ctor>(0 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(1 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(2 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(3 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(4 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(5 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(6 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(7 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(8 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(9 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(10 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(11 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(12 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(13 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(14 * sizeof(V)));
+                                use(load<V, Flags, Ctor>(15 * sizeof(V)));
+                              }
+                          });
+        };
+        size_t offset = 0;
+        return {
+          // load-to-use: the next address depends on the loaded value (includes
+          // the extraction of element 0)
+          0.25 * time_mean<400'000>([&] {
+                   offset = first_byte(load<V, Flags, false>(offset));
+                   offset = first_byte(load<V, Flags, false>(offset));
+                   offset = first_byte(load<V, Flags, false>(offset));
+                   offset = first_byte(load<V, Flags, false>(offset));
+                 }),
+          throughput(std::false_type()),
+          throughput(std::true_type())
+        };
+      }
+  };
+
+int
+main()
+{
+  bench_all<char, ElementAligned>();
+  bench_all<char, VectorAligned>();
+  bench_all<short, ElementAligned>();
+  bench_all<short, VectorAligned>();
+  bench_all<int, ElementAligned>();
+  bench_all<int, VectorAligned>();
+  bench_all<long long, ElementAligned>();
+  bench_all<long long, VectorAligned>();
+  bench_all<float, ElementAligned>();
+  bench_all<float, VectorAligned>();
+  bench_all<double, ElementAligned>();
+  bench_all<double, VectorAligned>();
+}
@@ -0,0 +1,219 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/* Copyright © 2026      GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                       Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#include "bench.h"
+#include <random>
+#include <bit>
+#include <climits>
+
+#include <sys/wait.h>
+
+alignas(64) char mem[64 * 64] = {};
+
+template <typename T>
+  inline T
+  load(typename T::mask_type k, const value_type_t<T>* ptr)
+  {
+    T x = {};
+    asm("":"+m,g,v,x"(x), "+g,v,x,m"(k));
+    // the memory could have changed: load again on every call
+    asm volatile("":::"memory");
+#if USE_STD_SIMD
+    x.copy_from(ptr, k);
+#else
+    where(k, x).copy_from(ptr, stdx::element_aligned);
+#endif
+    return x;
+  }
+
+template <typename T>
+  concept fixed_size
+#if USE_STD_SIMD
+    = not (requires (const T x) { {auto(__data(x))} -> vec_builtin; }
+             or requires (const T x) {
+               {auto(__data(x))} -> std::same_as<typename T::value_type>;
+             });
+#else
+    = requires (const T& v,
+                void (&fun)(const stdx::fixed_size_simd<typename T::value_type, T::size()>&)) {
+      fun(v);
+    };
+#endif
+
+constexpr auto aligned
+#if USE_STD_SIMD
+  = std::simd_flag_aligned;
+#else
+  = stdx::vector_aligned;
+#endif
+
+/**
+ * The end of a readable page that is followed by a PROT_NONE page, so that
+ * every access beyond it faults.
+ */
+[[gnu::noinline]] const char*
+guarded_end()
+{
+  static const char* const end = [] {
+    const long size = sysconf(_SC_PAGESIZE);
+    void* p = mmap(nullptr, 2 * size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED or mprotect(static_cast<char*>(p) + size, size, PROT_NONE) != 0)
+      {
+        std::cerr << "cannot set up the guard page: " << std::strerror(errno) << '\n';
+        std::exit(1);
+      }
+    return static_cast<const char*>(p) + size;
+  }();
+  return end;
+}
+
+/**
+ * Whether the masked loads of the last n < V::size() elements before the guard
+ * page stay within the readable page. They run once per V in a child process,
+ * which dies from SIGSEGV otherwise.
+ */
+template <class V, class UV>
+  [[gnu::noinline]] bool
+  fault_safe()
+  {
+    static const bool safe = [] {
+      using T = value_type_t<V>;
+      using U = value_type_t<UV>;
+      const T* end = reinterpret_cast<const T*>(guarded_end());
+      const UV iota([](U i) { return i; });
+      const pid_t pid = fork();
+      if (pid == 0)
+        {
+          for (int n = 0; n < int(V::size()); ++n)
+            fake_read(load<V>(
+#if not USE_STD_SIMD
+                        stdx::static_simd_cast<typename V::mask_type>
+#endif
+                          (iota < U(n)), end - n));
+          _exit(0);
+        }
+      int status = 0;
+      const bool r = pid > 0 and waitpid(pid, &status, 0) == pid and WIFEXITED(status)
+                       and WEXITSTATUS(status) == 0;
+      if (not r)
+        std::cerr << "masked load of " << value_type_name<T>() << " × " << V::size()
+                  << " reads beyond the guard page\n";
+      return r;
+    }();
+    return safe;
+  }
+
+template <int Special>
+  struct Benchmark<Special>
+  {
+    static constexpr Info<4> info
+      = {"Random Mask", "Epilogue Mask", "Guard Page", "Scalar Tail"};
+
+    template <typename T>
+      static constexpr bool accept = std::default_initializable<T>
+                                       and requires { typename T::abi_type; }
+                                       and not fixed_size<T>;
+
+    template <class V>
+      static Times<4>
+      run()
+      {
+        using T = value_type_t<V>;
+#if USE_STD_SIMD
+        using U = std::__detail::__make_unsigned_int_t<T>;
+        using UV = std::rebind_simd_t<U, V>;
+#else
+        using U = std::make_unsigned_t<stdx::__int_for_sizeof_t<T>>;
+        using UV = stdx::rebind_simd_t<U, V>;
+#endif
+        constexpr auto mem_alignment
+#if USE_STD_SIMD
+          = std::simd_alignment_v<V>;
+#else
+          = stdx::memory_alignment_v<V>;
+#endif
+
+        alignas(mem_alignment) T masks[1024 + V::size()] = {};
+        // fixed seed: every row measures the same masks
+        std::mt19937 gen(1);
+        std::uniform_int_distribution<unsigned> dist_unsigned;
+        for (auto& b : masks)
+          b = (dist_unsigned(gen) & 0x100) == 0 ? T(1) : T(0);
+
+        const T* const ptr = reinterpret_cast<const T*>(mem);
+        // the last element of the readable page is end[-1]
+        const T* const end = reinterpret_cast<const T*>(guarded_end());
+
+        UV iota([](U i) { return i; });
+        auto&& epilogue_mask = [&](size_t n) [[gnu::always_inline]] -> typename V::mask_type {
+          return
+#if not USE_STD_SIMD
+            stdx::static_simd_cast<typename V::mask_type>
+#endif
+              (iota < U(n));
+        };
+
+        const bool safe = fault_safe<V, UV>();
+
+        return {
+          time_mean2<800'000>([&](auto& need_more)
+          {
+            while (need_more)
+              {
+                asm ("":"+m"(*masks));
+                size_t i = (need_more.it * V::size()) % 1024;
+                typename V::mask_type k = V(&masks[i]
+#if not USE_STD_SIMD
+                                              , stdx::element_aligned
+#endif
+                                           ) == T();
+                fake_read(load<V>(k, ptr));
+              }
+          }),
+          time_mean2<800'000>([&](auto& need_more)
+          {
+            fake_modify(iota);
+            while (need_more)
+              fake_read(load<V>(epilogue_mask(need_more.it % V::size()), ptr));
+          }),
+          // the last n elements before the guard page, with the rest of the
+          // vector on the PROT_NONE page
+          safe ? time_mean2<800'000>([&](auto& need_more)
+                 {
+                   fake_modify(iota);
+                   while (need_more)
+                     {
+                       const size_t n = need_more.it % V::size();
+                       fake_read(load<V>(epilogue_mask(n), end - n));
+                     }
+                 })
+               : Measurement(std::numeric_limits<double>::quiet_NaN()),
+          // the same with a scalar remainder loop
+          time_mean2<800'000>([&](auto& need_more)
+          {
+            while (need_more)
+              {
+                const size_t n = need_more.it % V::size();
+                alignas(mem_alignment) T tmp[V::size()] = {};
+                asm volatile("":::"memory");
+                for (size_t i = 0; i < n; ++i)
+                  tmp[i] = (end - n)[i];
+                fake_read(V(tmp, aligned));
+              }
+          })
+        };
+      }
+  };
+
+int
+main()
+{
+  bench_all<char>();
+  bench_all<short>();
+  bench_all<int>();
+  bench_all<long long>();
+  bench_all<float>();
+  bench_all<double>();
+}
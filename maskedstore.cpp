@@ -8,29 +8,30 @@
 #include <bit>
 #include <climits>
 
-alignas(64) char mem[64 * 64] = {};
+// per thread, for the scaling mode
+alignas(64) thread_local char mem[64 * 64] = {};
+
+// the misalignment sweep: one store at an offset < 64 or across a page boundary
+alignas(4096) thread_local char pages[2 * 4096] = {};
 
 template <typename T>
   static T value = {};
 
 template <typename T>
   inline void
-  store(T& x, typename T::mask_type k, size_t offset = 0)
+  store(T& x, typename T::mask_type k, size_t offset = 0, char* base = mem)
   {
     using Mem = value_type_t<T>;
-    Mem* ptr = reinterpret_cast<Mem*>(mem + offset);
+    Mem* ptr = reinterpret_cast<Mem*>(base + offset);
     asm("":"+m,g,v,x"(x), "+g,v,x,m"(k));
 #if USE_STD_SIMD
     x.copy_to(ptr, k);
 #else
     where(k, x).copy_to(ptr, stdx::element_aligned);
 #endif
-    asm(""::"m"(*mem));
+    asm(""::"m"(*base));
   }
 
-std::random_device rd;
-std::mt19937 gen(rd());
-
 template <typename T>
   concept fixed_size
 #if USE_STD_SIMD
@@ -91,6 +92,8 @@ template <int Special>
 
 
         alignas(mem_alignment) T masks[1024 + V::size()] = {};
+        // seeded per row, so that filtering does not change the masks
+        std::mt19937 gen(1);
         std::uniform_int_distribution<unsigned> dist_unsigned;
         for (auto& b : masks)
           b = (dist_unsigned(gen) & 0x100) == 0 ? T(1) : T(0);
@@ -197,6 +200,160 @@ template <int Special>
 
 static_assert(accept_type_for_benchmark<simd<float, 1>, Benchmark<0>>);
 
+/**
+ * The "Random Mask" store at \p base. Not a member of Benchmark, so that all
+ * columns and tables of the misalignment sweep share it.
+ */
+template <class V>
+  [[gnu::noinline]] Measurement
+  random_mask_store(value_type_t<V>* masks, char* base)
+  {
+    using T = value_type_t<V>;
+    // element_aligned requires an address aligned to the element type: the
+    // offsets in between are skipped
+    if (reinterpret_cast<std::uintptr_t>(base) % alignof(T) != 0)
+      return Measurement(std::numeric_limits<double>::quiet_NaN());
+    return time_mean2<800'000>([&](auto& need_more) {
+             V obj = {};
+             while (need_more)
+               {
+                 asm ("":"+m"(*masks));
+                 size_t i = (need_more.it * V::size()) % 1024;
+                 typename V::mask_type k = V(&masks[i]
+#if not USE_STD_SIMD
+                                               , stdx::element_aligned
+#endif
+                                            ) == T();
+                 store<V>(obj, k, 0, base);
+               }
+           });
+  }
+
+/**
+ * The misalignment sweep: the "Random Mask" store at the byte offset of the
+ * column (Misaligned) or across a page boundary (PageSplit).
+ */
+template <int Special, class Position>
+  requires requires { Position::offsets; }
+  struct Benchmark<Special, Position>
+  {
+    static constexpr auto info = Position::info;
+
+    template <typename T>
+      static constexpr bool accept = Benchmark<Special>::template accept<T>;
+
+    template <class V>
+      static Times<info.size()>
+      run()
+      {
+        using T = value_type_t<V>;
+        alignas(64) T masks[1024 + V::size()] = {};
+        // seeded per row, so that filtering does not change the masks
+        std::mt19937 gen(1);
+        std::uniform_int_distribution<unsigned> dist_unsigned;
+        for (auto& b : masks)
+          b = (dist_unsigned(gen) & 0x100) == 0 ? T(1) : T(0);
+
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+          return Times<info.size()>(
+                   random_mask_store<V>(masks, pages + (Position::page_split ? 4096 : 0)
+                                                 + Position::offsets[Is])...);
+        }(std::make_index_sequence<info.size()>());
+      }
+  };
+
+/**
+ * The mask density sweep: element i of every vector is set with probability
+ * sixteenths[column] / 16.
+ */
+struct Density
+{
+  static constexpr char name[] = "  density";
+
+  static constexpr Info<6> info = {"all false", "1/16", "1/4", "1/2", "15/16", "all true"};
+
+  static constexpr std::array<unsigned, 6> sixteenths = {0, 1, 4, 8, 15, 16};
+
+  static void
+  fill(int column, bool* set, int width, std::mt19937& rng)
+  {
+    for (int i = 0; i < width; ++i)
+      set[i] = rng() % 16 < sixteenths[column];
+  }
+};
+
+/**
+ * The mask structure sweep: the first or last n elements of every vector, with
+ * n uniformly random in [0, width], or every other element.
+ */
+struct Structure
+{
+  static constexpr char name[] = "structure";
+
+  static constexpr Info<3> info = {"prefix", "suffix", "alternating"};
+
+  static void
+  fill(int column, bool* set, int width, std::mt19937& rng)
+  {
+    const int n = std::uniform_int_distribution<int>(0, width)(rng);
+    for (int i = 0; i < width; ++i)
+      set[i] = column == 0 ? i < n : column == 1 ? i >= width - n : i % 2 == 0;
+  }
+};
+
+/**
+ * The "Random Mask" store with the mask workloads of the columns of \p Masks
+ * (Density or Structure). Each row is a curve of throughput over the workloads.
+ */
+template <int Special, class Masks>
+  requires requires { Masks::fill; }
+  struct Benchmark<Special, Masks>
+  {
+    static constexpr auto info = Masks::info;
+
+    template <typename T>
+      static constexpr bool accept = Benchmark<Special>::template accept<T>;
+
+    template <class V>
+      static Times<info.size()>
+      run()
+      {
+        using T = value_type_t<V>;
+        constexpr int N = 1024 + V::size();
+        alignas(64) T masks[info.size()][N] = {};
+        // seeded per row, so that filtering does not change the masks
+        std::mt19937 rng(1);
+        for (int column = 0; column < int(info.size()); ++column)
+          for (int i = 0; i < N; i += V::size())
+            {
+              bool set[V::size()];
+              Masks::fill(column, set, V::size(), rng);
+              // random_mask_store sets the elements where masks is zero
+              for (int j = 0; j < int(V::size()); ++j)
+                masks[column][i + j] = set[j] ? T(0) : T(1);
+            }
+
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+          return Times<info.size()>(random_mask_store<V>(masks[Is], mem)...);
+        }(std::make_index_sequence<info.size()>());
+      }
+  };
+
+template <class T>
+  void
+  bench_misaligned()
+  {
+    bench_all<T, Misaligned<0>>();
+    bench_all<T, Misaligned<8>>();
+    bench_all<T, Misaligned<16>>();
+    bench_all<T, Misaligned<24>>();
+    bench_all<T, Misaligned<32>>();
+    bench_all<T, Misaligned<40>>();
+    bench_all<T, Misaligned<48>>();
+    bench_all<T, Misaligned<56>>();
+    bench_all<T, PageSplit>();
+  }
+
 int
 main()
 {
@@ -206,4 +363,24 @@ main()
   bench_all<long long>();
   bench_all<float>();
   bench_all<double>();
+
+  bench_misaligned<char>();
+  bench_misaligned<short>();
+  bench_misaligned<int>();
+  bench_misaligned<long long>();
+  bench_misaligned<float>();
+  bench_misaligned<double>();
+
+  bench_all<char, Density>();
+  bench_all<char, Structure>();
+  bench_all<short, Density>();
+  bench_all<short, Structure>();
+  bench_all<int, Density>();
+  bench_all<int, Structure>();
+  bench_all<long long, Density>();
+  bench_all<long long, Structure>();
+  bench_all<float, Density>();
+  bench_all<float, Structure>();
+  bench_all<double, Density>();
+  bench_all<double, Structure>();
 }
@@ -0,0 +1,256 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/* Copyright © 2026      GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                       Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#ifndef PERF_H_
+#define PERF_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+/**
+ * A perf_event_open counter for the calling thread, counting user-space events
+ * only unless \p user_only is false (some PMUs, e.g. msr, reject the filter).
+ *
+ * If \p map is true, the event's metadata page is mapped. This enables reading
+ * the counter with rdpmc instead of a system call if the kernel permits it.
+ */
+class PerfEvent
+{
+  friend class PerfGroup;
+
+  int fd = -1;
+  perf_event_mmap_page* page = nullptr;
+
+public:
+  PerfEvent() = default;
+
+  PerfEvent(std::uint32_t type, std::uint64_t config, bool map = false,
+            const PerfEvent* leader = nullptr, std::uint64_t read_format = 0,
+            bool user_only = true)
+  {
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = read_format;
+    attr.exclude_kernel = user_only;
+    attr.exclude_hv = user_only;
+    fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader ? leader->fd : -1,
+                 PERF_FLAG_FD_CLOEXEC);
+    if (fd >= 0 and map)
+      {
+        void* p = mmap(nullptr, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED)
+          page = static_cast<perf_event_mmap_page*>(p);
+      }
+  }
+
+  PerfEvent(PerfEvent&& rhs)
+  : fd(std::exchange(rhs.fd, -1)), page(std::exchange(rhs.page, nullptr))
+  {}
+
+  PerfEvent&
+  operator=(PerfEvent&& rhs)
+  {
+    std::swap(fd, rhs.fd);
+    std::swap(page, rhs.page);
+    return *this;
+  }
+
+  ~PerfEvent()
+  {
+    if (page)
+      munmap(page, sysconf(_SC_PAGESIZE));
+    if (fd >= 0)
+      close(fd);
+  }
+
+  explicit
+  operator bool() const
+  { return fd >= 0; }
+
+  /**
+   * Whether read() can use rdpmc.
+   */
+  bool
+  has_rdpmc() const
+  { return page != nullptr and page->cap_user_rdpmc; }
+
+  [[gnu::always_inline]] std::uint64_t
+  read() const
+  {
+    if (page != nullptr and page->cap_user_rdpmc) [[likely]]
+      {
+        // the seqlock protocol documented in <linux/perf_event.h>
+        std::uint32_t seq, index;
+        std::int64_t count;
+        do
+          {
+            seq = page->lock;
+            asm volatile("" ::: "memory");
+            index = page->index;
+            count = page->offset;
+            if (index != 0) [[likely]]
+              {
+                const int shift = 64 - page->pmc_width;
+                count += std::int64_t(__rdpmc(index - 1) << shift) >> shift;
+              }
+            asm volatile("" ::: "memory");
+          }
+        while (page->lock != seq);
+        if (index != 0) [[likely]]
+          return count;
+      }
+    std::uint64_t count = 0;
+    if (::read(fd, &count, sizeof(count)) != sizeof(count))
+      return 0;
+    return count;
+  }
+};
+
+/**
+ * Events that are always scheduled together on the PMU and read with a single
+ * system call.
+ */
+class PerfGroup
+{
+  std::vector<PerfEvent> events;
+
+public:
+  /**
+   * Adds an event to the group. The first event becomes the group leader.
+   * Returns false if the event cannot be opened.
+   */
+  bool
+  add(std::uint32_t type, std::uint64_t config, bool user_only = true)
+  {
+    if (events.empty())
+      events.emplace_back(type, config, false, nullptr,
+                          PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                            | PERF_FORMAT_TOTAL_TIME_RUNNING, user_only);
+    else
+      events.emplace_back(type, config, false, &events.front(), 0, user_only);
+    if (events.back())
+      return true;
+    events.pop_back();
+    return false;
+  }
+
+  int
+  size() const
+  { return events.size(); }
+
+  /**
+   * Reads all counters of the group into \p values. Returns false if the group
+   * was never scheduled on the PMU. Counts are extrapolated if the PMU was
+   * multiplexed between several groups.
+   */
+  bool
+  read(std::uint64_t* values) const
+  {
+    if (events.empty())
+      return false;
+    std::uint64_t buf[3 + 16];
+    const std::size_t bytes = (3 + events.size()) * sizeof(std::uint64_t);
+    if (events.size() > 16 or ::read(events.front().fd, buf, bytes) != ssize_t(bytes))
+      return false;
+    const std::uint64_t enabled = buf[1];
+    const std::uint64_t running = buf[2];
+    if (running == 0)
+      return false;
+    for (std::size_t i = 0; i < events.size(); ++i)
+      values[i] = running == enabled ? buf[3 + i]
+                                     : std::uint64_t(double(buf[3 + i]) * enabled / running);
+    return true;
+  }
+};
+
+/**
+ * Translates a perf event name into perf_event_attr type and config. Supports
+ * the generic hardware events (as named by perf-list) and raw events written
+ * as "r<hex>" (as in perf-record -e).
+ */
+inline bool
+parse_perf_event(std::string_view name, std::uint32_t& type, std::uint64_t& config)
+{
+  static constexpr std::pair<std::string_view, std::uint64_t> generic[] = {
+    {"cycles", PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_COUNT_HW_INSTRUCTIONS},
+    {"cache-references", PERF_COUNT_HW_CACHE_REFERENCES},
+    {"cache-misses", PERF_COUNT_HW_CACHE_MISSES},
+    {"branches", PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+    {"branch-misses", PERF_COUNT_HW_BRANCH_MISSES},
+    {"bus-cycles", PERF_COUNT_HW_BUS_CYCLES},
+    {"stalled-cycles-frontend", PERF_COUNT_HW_STALLED_CYCLES_FRONTEND},
+    {"stalled-cycles-backend", PERF_COUNT_HW_STALLED_CYCLES_BACKEND},
+    {"ref-cycles", PERF_COUNT_HW_REF_CPU_CYCLES},
+  };
+  for (const auto& [generic_name, generic_config] : generic)
+    if (name == generic_name)
+      {
+        type = PERF_TYPE_HARDWARE;
+        config = generic_config;
+        return true;
+      }
+  if (name.size() < 2 or name.size() > 17 or name[0] != 'r')
+    return false;
+  config = 0;
+  for (char c : name.substr(1))
+    {
+      const int digit = c >= '0' and c <= '9' ? c - '0'
+                          : c >= 'a' and c <= 'f' ? c - 'a' + 10
+                          : c >= 'A' and c <= 'F' ? c - 'A' + 10 : -1;
+      if (digit < 0)
+        return false;
+      config = config * 16 + digit;
+    }
+  type = PERF_TYPE_RAW;
+  return true;
+}
+
+/**
+ * Looks up an event that a dynamic PMU publishes in sysfs, e.g. ("msr",
+ * "aperf"). Only events of the form "event=<hex>" are supported.
+ */
+inline bool
+parse_pmu_event(const std::string& pmu, const std::string& event, std::uint32_t& type,
+                std::uint64_t& config)
+{
+  const std::string dir = "/sys/bus/event_source/devices/" + pmu;
+  unsigned long long pmu_type, event_config;
+  if (std::FILE* f = std::fopen((dir + "/type").c_str(), "r"))
+    {
+      const int n = std::fscanf(f, "%llu", &pmu_type);
+      std::fclose(f);
+      if (n != 1)
+        return false;
+    }
+  else
+    return false;
+  if (std::FILE* f = std::fopen((dir + "/events/" + event).c_str(), "r"))
+    {
+      const int n = std::fscanf(f, "event=%llx", &event_config);
+      std::fclose(f);
+      if (n != 1)
+        return false;
+    }
+  else
+    return false;
+  type = pmu_type;
+  config = event_config;
+  return true;
+}
+
+#endif  // PERF_H_
@@ -0,0 +1,75 @@
+#!/bin/bash
+
+dir="${0%/*}"
+[[ "$dir" == '.' ]] && dir="$PWD"
+
+usage() {
+  cat <<EOF2
+Usage: $0 <target> [--filter=<terms>] [--time=<seconds>] [-- <perf record options>]
+
+Records a profile of bin/<target> (e.g. maskedstore-default-native) with
+'perf record' into data/<target>.perf.data. Every row matching <terms> (see
+BENCH_FILTER in README.md) is measured as usual and then run again for
+<seconds> (default: 10). perf only samples while the timing loops of these
+runs execute, not during setup such as the generation of input data.
+
+Afterwards:
+  perf report -i data/<target>.perf.data
+  perf annotate -i data/<target>.perf.data
+EOF2
+}
+
+target=
+filter=
+seconds=10
+perf_args=()
+while (($# > 0)); do
+  case "$1" in
+    -h|--help)
+      usage
+      exit 0
+      ;;
+    --filter=*)
+      filter="${1#--filter=}"
+      ;;
+    --time=*)
+      seconds="${1#--time=}"
+      ;;
+    --)
+      shift
+      perf_args=("$@")
+      break
+      ;;
+    *)
+      if [[ -n "$target" ]]; then
+        usage
+        exit 1
+      elif [[ ! -x "$dir/bin/$1" ]]; then
+        echo "ERROR: '$dir/bin/$1' does not exist. Call 'make bin/$1' first."
+        exit 1
+      fi
+      target="$1"
+      ;;
+  esac
+  shift
+done
+
+if [[ -z "$target" ]]; then
+  usage
+  exit 1
+fi
+if [[ -z "$filter" ]]; then
+  echo "WARNING: no --filter given, every row of the benchmark is profiled for $seconds s"
+fi
+
+tmp="$(mktemp -d)"
+trap 'rm -rf "$tmp"' EXIT
+mkfifo "$tmp/ctl" "$tmp/ack"
+mkdir -p "$dir/data"
+
+# -D -1 starts with the events disabled until the benchmark enables them
+BENCH_FILTER="$filter" BENCH_PROFILE="$seconds" BENCH_PROFILE_CTL="$tmp/ctl,$tmp/ack" \
+  perf record -D -1 --control="fifo:$tmp/ctl,$tmp/ack" -o "$dir/data/$target.perf.data" \
+  "${perf_args[@]}" -- "$dir/bin/$target"
+
+# vim: tw=0 si sw=2
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-3.0-or-later
+# Copyright © 2026      GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+#                       Matthias Kretz <m.kretz@gsi.de>
+
+"""Side-by-side report of the benchmark × variant × arch matrix.
+
+Reads data/<bench>[-<compiler>]-<variant>-<arch>.jsonl (as written by
+`make benchmark`) and writes a static HTML page with inline SVG charts:
+
+- per benchmark, type, flags and column, a chart of cycles per value over the
+  simd width, with one line per (compiler/)variant/arch;
+- per benchmark and column, a table of cycles per value of every row for all
+  (compiler/)variant/arch combinations. Cells of non-default variants are
+  highlighted where they differ significantly (non-overlapping confidence
+  intervals and more than --threshold) from the default variant of the same
+  compiler on the same arch.
+
+  report.py [-o <file.html>] [--threshold 0.1] [<file.jsonl>...]
+
+Without arguments it reads data/*.jsonl and writes data/report.html.
+"""
+
+import argparse
+import glob
+import html
+import json
+import math
+import os
+import sys
+from collections import defaultdict
+
+from resultdb import is_result
+
+COLORS = ["#1f77b4", "#ff7f0e", "#2ca02c", "#d62728", "#9467bd", "#8c564b",
+          "#e377c2", "#7f7f7f", "#bcbd22", "#17becf"]
+DASHES = {"default": "", "fastmath": "6,3", "stdsimd": "2,2"}
+VARIANTS = list(DASHES)
+
+
+def load(paths):
+    """Returns {(bench, compiler, variant, arch): [records]}."""
+    runs = {}
+    for path in paths:
+        parts = os.path.basename(path).removesuffix(".jsonl").split("-")
+        i = next((i for i in range(1, len(parts) - 1) if parts[i] in VARIANTS), None)
+        if i is None:
+            print(f"{path}: expected <bench>[-<compiler>]-<variant>-<arch>.jsonl, skipped",
+                  file=sys.stderr)
+            continue
+        with open(path) as f:
+            records = [r for r in map(json.loads, filter(str.strip, f)) if is_result(r)]
+        if records:
+            runs[(parts[0], "-".join(parts[1:i]), parts[i], "-".join(parts[i + 1:]))] = records
+    return runs
+
+
+def per_value(r, key="median"):
+    v = r.get(key)
+    return None if v is None or not r["width"] else v / r["width"]
+
+
+def svg_chart(title, lines):
+    """lines: {label: (dash, [(width, cycles/value)])}; log2 x, log10 y."""
+    w, h, left, right, top, bottom = 640, 320, 60, 170, 24, 36
+    points = [p for _, pts in lines.values() for p in pts if p[1] and p[1] > 0]
+    if not points:
+        return ""
+    xmax = max(math.log2(p[0]) for p in points) or 1
+    ymin = math.floor(math.log10(min(p[1] for p in points)))
+    ymax = math.ceil(math.log10(max(p[1] for p in points)))
+    ymax = max(ymax, ymin + 1)
+    sx = lambda x: left + (w - left - right) * math.log2(x) / xmax
+    sy = lambda y: top + (h - top - bottom) * (ymax - math.log10(y)) / (ymax - ymin)
+    out = [f'<svg xmlns="http://www.w3.org/2000/svg" width="{w}" height="{h}" '
+           f'font-family="sans-serif" font-size="11">',
+           f'<text x="{left}" y="14" font-weight="bold">{html.escape(title)}</text>']
+    for e in range(ymin, ymax + 1):
+        y = sy(10 ** e)
+        out.append(f'<line x1="{left}" x2="{w - right}" y1="{y:.1f}" y2="{y:.1f}" stroke="#ddd"/>'
+                   f'<text x="{left - 4}" y="{y + 4:.1f}" text-anchor="end">{10.0 ** e:g}</text>')
+    for i in range(int(xmax) + 1):
+        x = sx(2 ** i)
+        out.append(f'<line x1="{x:.1f}" x2="{x:.1f}" y1="{top}" y2="{h - bottom}" stroke="#eee"/>'
+                   f'<text x="{x:.1f}" y="{h - bottom + 14}" text-anchor="middle">{2 ** i}</text>')
+    out.append(f'<text x="{(left + w - right) / 2}" y="{h - 6}" text-anchor="middle">'
+               f'simd width</text>'
+               f'<text x="12" y="{(top + h - bottom) / 2}" text-anchor="middle" '
+               f'transform="rotate(-90 12 {(top + h - bottom) / 2})">cycles/value</text>')
+    for i, (label, (dash, pts)) in enumerate(sorted(lines.items())):
+        color = COLORS[i % len(COLORS)]
+        pts = sorted(p for p in pts if p[1] and p[1] > 0)
+        coords = " ".join(f"{sx(x):.1f},{sy(y):.1f}" for x, y in pts)
+        out.append(f'<polyline fill="none" stroke="{color}" stroke-width="1.5" '
+                   f'stroke-dasharray="{dash}" points="{coords}"/>')
+        ly = top + 14 * i
+        out.append(f'<line x1="{w - right + 8}" x2="{w - right + 28}" y1="{ly}" y2="{ly}" '
+                   f'stroke="{color}" stroke-width="1.5" stroke-dasharray="{dash}"/>'
+                   f'<text x="{w - right + 32}" y="{ly + 4}">{html.escape(label)}</text>')
+    out.append("</svg>")
+    return "\n".join(out)
+
+
+def significant(base, other, threshold):
+    """Relative change of other against base, or None if not significant."""
+    b, o = per_value(base), per_value(other)
+    if not b or o is None:
+        return None
+    ratio = o / b
+    if abs(ratio - 1) <= threshold:
+        return None
+    if None not in (base.get("ci_low"), base.get("ci_high"), other.get("ci_low"),
+                    other.get("ci_high")):
+        if other["ci_low"] <= base["ci_high"] and base["ci_low"] <= other["ci_high"]:
+            return None
+    return ratio - 1
+
+
+def report(runs, threshold):
+    benches = sorted({b for b, _, _, _ in runs})
+    out = ["<!DOCTYPE html>", "<html><head><meta charset='utf-8'>",
+           "<title>simd benchmarks</title><style>",
+           "body { font-family: sans-serif; } table { border-collapse: collapse; }",
+           "td, th { border: 1px solid #ccc; padding: 2px 6px; text-align: right; }",
+           "th { background: #eee; } .faster { background: #bfb; } .slower { background: #fbb; }",
+           "</style></head><body>", "<h1>stdx::simd benchmarks</h1>"]
+    out.append("<p>" + " ".join(f'<a href="#{b}">{b}</a>' for b in benches) + "</p>")
+    for bench in benches:
+        out.append(f'<h2 id="{bench}">{bench}</h2>')
+        combos = sorted((c, v, a) for b, c, v, a in runs if b == bench)
+        # (type, flags, column) -> (compiler, variant, arch) -> abi -> record
+        cells = defaultdict(lambda: defaultdict(dict))
+        for combo in combos:
+            for r in runs[(bench,) + combo]:
+                cells[(r["type"], r["flags"], r["column"])][combo][r["abi"]] = r
+
+        for column in sorted({c for _, _, c in cells}):
+            out.append(f"<h3>{html.escape(column)} [cycles/value]</h3>")
+            out.append("<table><tr><th>type</th><th>flags</th><th>abi</th>"
+                       + "".join("<th>" + "<br>".join(html.escape(x) for x in combo if x)
+                                 + "</th>" for combo in combos) + "</tr>")
+            for key in sorted(k for k in cells if k[2] == column):
+                type_, flags, _ = key
+                abis = []
+                for by_abi in cells[key].values():
+                    abis += [a for a in by_abi if a not in abis]
+                for abi in abis:
+                    row = [f"<td>{html.escape(type_)}</td><td>{html.escape(flags)}</td>"
+                           f"<td>{html.escape(abi)}</td>"]
+                    for compiler, variant, arch in combos:
+                        r = cells[key][(compiler, variant, arch)].get(abi)
+                        value = per_value(r) if r else None
+                        if value is None:
+                            row.append("<td></td>")
+                            continue
+                        cls, note = "", ""
+                        base = cells[key].get((compiler, "default", arch), {}).get(abi)
+                        if variant != "default" and base:
+                            change = significant(base, r, threshold)
+                            if change is not None:
+                                cls = ' class="faster"' if change < 0 else ' class="slower"'
+                                note = f" ({change:+.0%})"
+                        row.append(f"<td{cls}>{value:.3g}{note}</td>")
+                    out.append("<tr>" + "".join(row) + "</tr>")
+            out.append("</table>")
+
+        for key in sorted(cells):
+            type_, flags, column = key
+            lines = {}
+            for (compiler, variant, arch), by_abi in cells[key].items():
+                pts = [(int(abi), per_value(r)) for abi, r in by_abi.items() if abi.isdigit()]
+                if len(pts) > 1:
+                    label = " ".join(filter(None, (compiler, variant, arch)))
+                    lines[label] = (DASHES[variant], pts)
+            chart = svg_chart(f"{bench}: {type_} {flags} {column}", lines)
+            if chart:
+                out.append(f"<div>{chart}</div>")
+    out.append("</body></html>")
+    return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--output", help="HTML file (default: data/report.html)")
+    parser.add_argument("--threshold", type=float, default=0.1,
+                        help="minimum relative change to highlight (default 0.1)")
+    parser.add_argument("files", nargs="*")
+    args = parser.parse_args()
+    data = os.path.join(os.path.dirname(os.path.abspath(__file__)), "data")
+    files = args.files or sorted(glob.glob(os.path.join(data, "*.jsonl")))
+    output = args.output or os.path.join(data, "report.html")
+    runs = load(files)
+    if not runs:
+        sys.exit("no result files found (run 'make benchmark' first)")
+    with open(output, "w") as f:
+        f.write(report(runs, args.threshold))
+    print(f"wrote {output} ({len(runs)} runs)")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
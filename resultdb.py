@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-3.0-or-later
+# Copyright © 2026      GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+#                       Matthias Kretz <m.kretz@gsi.de>
+
+"""Local store of benchmark results and regression detector.
+
+The benchmark binaries write JSON Lines files (BENCH_OUTPUT, see README.md);
+`make benchmark` puts them into data/. This script imports them into an SQLite
+database, keeping every run, and compares two sets of runs.
+
+  resultdb.py import [--tag <name>] <file.jsonl>...
+  resultdb.py list
+  resultdb.py compare [--threshold <fraction>] <baseline> <candidate>
+
+<baseline> and <candidate> select runs by ','-separated terms, all of which
+must match:
+  tag=<name>        the tag given on import
+  run=<id>          a single run (see list)
+  compiler=<glob>   e.g. 'compiler=GCC 13*'
+  host=<glob>, cxxflags=<glob>, benchmark=<glob>
+  since=<date>, until=<date>   import time, e.g. since=2026-10-01
+If several selected runs contain the same cell, the latest one is used.
+
+Cells are matched by host, compiler flags, benchmark, type, ABI, width, flags
+and column; if no cell matches, host and compiler flags are ignored. A change
+is reported if the 95% confidence intervals of the medians do not overlap and
+the medians differ by more than the threshold (default 0.02). compare exits
+with status 1 if it found a regression.
+
+The database is data/results.db next to this script, or $BENCH_DB.
+"""
+
+import argparse
+import datetime
+import fnmatch
+import hashlib
+import json
+import os
+import sqlite3
+import sys
+
+SCHEMA = """
+create table if not exists run (
+  id integer primary key,
+  imported text not null,
+  tag text,
+  file text,
+  sha256 text unique,
+  host text, cpu_model text, microcode text, kernel text,
+  compiler text, cxxflags text,
+  governor text, turbo text, smt text, clock text, warnings text
+);
+create table if not exists result (
+  run integer not null references run(id),
+  benchmark text, type text, abi text, width integer, flags text, column text,
+  cycles_per_call real, min real, median real, p90 real, mad real,
+  ci_low real, ci_high real, samples integer, speedup real
+);
+create index if not exists result_run on result(run);
+"""
+
+ENV_FIELDS = ["host", "cpu_model", "microcode", "kernel", "compiler", "cxxflags",
+              "governor", "turbo", "smt", "clock", "warnings"]
+RESULT_FIELDS = ["benchmark", "type", "abi", "width", "flags", "column",
+                 "cycles_per_call", "min", "median", "p90", "mad", "ci_low",
+                 "ci_high", "samples", "speedup"]
+CELL = ["benchmark", "type", "abi", "width", "flags", "column"]
+
+
+def is_result(record):
+    """Whether a record is a table cell (not the environment or a scaling record)."""
+    return "column" in record and "record" not in record
+
+
+def open_db():
+    path = os.environ.get("BENCH_DB") or os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), "data", "results.db")
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    db = sqlite3.connect(path)
+    db.row_factory = sqlite3.Row
+    db.executescript(SCHEMA)
+    return db
+
+
+def cmd_import(db, args):
+    for path in args.files:
+        with open(path, "rb") as f:
+            content = f.read()
+        digest = hashlib.sha256(content).hexdigest()
+        if db.execute("select 1 from run where sha256 = ?", (digest,)).fetchone():
+            print(f"{path}: already imported")
+            continue
+        env, rows = {}, []
+        for line in content.decode().splitlines():
+            if not line.strip():
+                continue
+            record = json.loads(line)
+            if record.get("record") == "environment":
+                env = record
+            elif is_result(record):
+                rows.append(record)
+        if not rows:
+            print(f"{path}: no results, skipped")
+            continue
+        imported = datetime.datetime.now().isoformat(timespec="seconds")
+        run = db.execute(
+            f"insert into run (imported, tag, file, sha256, {', '.join(ENV_FIELDS)}) "
+            f"values (?, ?, ?, ?, {', '.join('?' * len(ENV_FIELDS))})",
+            [imported, args.tag, os.path.abspath(path), digest]
+            + [env.get(k) for k in ENV_FIELDS]).lastrowid
+        db.executemany(
+            f"insert into result (run, {', '.join(RESULT_FIELDS)}) "
+            f"values (?, {', '.join('?' * len(RESULT_FIELDS))})",
+            [[run] + [r.get(k) for k in RESULT_FIELDS] for r in rows])
+        print(f"{path}: imported {len(rows)} results as run {run}")
+    db.commit()
+
+
+def cmd_list(db, args):
+    for run in db.execute(
+            "select run.*, group_concat(distinct result.benchmark) as benchmarks "
+            "from run join result on result.run = run.id group by run.id order by run.id"):
+        print(f"{run['id']:5} {run['imported']} {run['tag'] or '-':12} "
+              f"{run['benchmarks']:12} {run['host']} | {run['compiler']} | {run['cxxflags']}")
+
+
+def select_runs(db, selector):
+    """Returns the ids of the runs matching selector, oldest first."""
+    terms = [t for t in selector.split(",") if t]
+    ids = []
+    for run in db.execute("select run.*, group_concat(distinct result.benchmark) as benchmark "
+                          "from run join result on result.run = run.id "
+                          "group by run.id order by run.id"):
+        def matches(term):
+            key, _, value = term.partition("=")
+            if key == "run":
+                return str(run["id"]) == value
+            if key == "tag":
+                return run["tag"] == value
+            if key == "since":
+                return run["imported"] >= value
+            if key == "until":
+                return run["imported"] < value
+            if key in ("compiler", "host", "cxxflags"):
+                return fnmatch.fnmatchcase(run[key] or "", value)
+            if key == "benchmark":
+                return any(fnmatch.fnmatchcase(b, value) for b in run[key].split(","))
+            sys.exit(f"unknown selector term '{term}'")
+        if all(matches(t) for t in terms):
+            ids.append(run["id"])
+    return ids
+
+
+def latest_cells(db, ids):
+    """Maps (host, cxxflags, cell...) to the result of the latest run in ids."""
+    cells = {}
+    for run in ids:
+        for r in db.execute("select run.host, run.cxxflags, result.* from result "
+                            "join run on run.id = result.run where run.id = ?", (run,)):
+            cells[(r["host"], r["cxxflags"]) + tuple(r[k] for k in CELL)] = r
+    return cells
+
+
+def cmd_compare(db, args):
+    base_ids = select_runs(db, args.baseline)
+    new_ids = select_runs(db, args.candidate)
+    if not base_ids or not new_ids:
+        sys.exit(f"no runs match '{args.baseline if not base_ids else args.candidate}'")
+    base = latest_cells(db, base_ids)
+    new = latest_cells(db, new_ids)
+    common = sorted(set(base) & set(new), key=lambda k: tuple(str(x) for x in k))
+    if not common:
+        # different compilers usually mean different flags strings, too
+        strip = lambda cells: {k[2:]: v for k, v in cells.items()}
+        base, new = strip(base), strip(new)
+        common = sorted(set(base) & set(new), key=lambda k: tuple(str(x) for x in k))
+    changes = []
+    for key in common:
+        b, n = base[key], new[key]
+        if not b["median"] or n["median"] is None:
+            continue
+        ratio = n["median"] / b["median"]
+        disjoint = (None not in (b["ci_low"], b["ci_high"], n["ci_low"], n["ci_high"])
+                    and (n["ci_low"] > b["ci_high"] or n["ci_high"] < b["ci_low"]))
+        if disjoint and abs(ratio - 1) > args.threshold:
+            changes.append((ratio, b, n))
+    regressions = sorted((c for c in changes if c[0] > 1), key=lambda c: -c[0])
+    improvements = sorted((c for c in changes if c[0] < 1), key=lambda c: c[0])
+    print(f"compared {len(common)} cells of runs {base_ids} against {new_ids}")
+    for title, group in (("regressions", regressions), ("improvements", improvements)):
+        print(f"\n{len(group)} {title}:")
+        for ratio, b, n in group:
+            print(f"  {b['benchmark']:12} {b['type']:>6} {b['abi']:>12} {b['flags'][:28]:28} "
+                  f"{b['column']:>12}: {b['median']:9.4g} -> {n['median']:9.4g} "
+                  f"cycles/call ({ratio - 1:+.1%})")
+    return 1 if regressions else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("import", help="import JSON Lines result files")
+    p.add_argument("--tag", help="name for the imported runs, e.g. 'g++-14'")
+    p.add_argument("files", nargs="+")
+    sub.add_parser("list", help="list all runs")
+    p = sub.add_parser("compare", help="report significant changes")
+    p.add_argument("--threshold", type=float, default=0.02,
+                   help="minimum relative change of the median (default 0.02)")
+    p.add_argument("baseline")
+    p.add_argument("candidate")
+    args = parser.parse_args()
+
+    db = open_db()
+    return {"import": cmd_import, "list": cmd_list, "compare": cmd_compare}[args.command](
+        db, args) or 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -46,7 +46,7 @@ template <int Special, class What>
     static constexpr Info<2> info = {"Latency", "Throughput"};
 
     template <bool Latency, class T>
-      static double
+      static Measurement
       do_benchmark()
       {
         std::vector<T> input;
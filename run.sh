@@ -6,7 +6,7 @@ dir="${0%/*}"
 usage() {
   archlist=$($CXX -x c++ -march=xxx - 2>&1 </dev/null|grep 'valid arguments'|sed 's/^.*are: //')
   cat <<EOF
-Usage: $0 <name> [<compiler -std -f -O -include -I or -D flags>] [<arch list>]
+Usage: $0 <name> [<compiler -std -f -O -include -I or -D flags>] [--filter=<terms>] [--cxx=<compiler>...] [<arch list>]
 
 <name> must be one of:
 $(cd "$dir"; echo *.cpp|sed 's/\.cpp\>//g')
@@ -14,6 +14,13 @@ $(cd "$dir"; echo *.cpp|sed 's/\.cpp\>//g')
 <arch list> can be any combination of:
 $archlist
 
+--filter=<terms> only measures the matching table rows, e.g.
+'type=float;width=8|16'. It sets BENCH_FILTER (see README.md).
+
+--cxx=<compiler> builds with <compiler> instead of \$CXX. If given more than
+once, every compiler builds bin/<name>-<compiler>-<arch>, and a side-by-side
+table with the first compiler as reference follows the runs (compilers.py).
+
 The arguments can be given in any order.
 EOF
 }
@@ -38,12 +45,27 @@ set_name() {
 std=-std=gnu++2b
 opt=-O3
 flags=("-static-libstdc++")
+compilers=()
 while (($# > 0)); do
   case "$1" in
     -h|--help)
       usage
       exit 0
       ;;
+    --filter=*)
+      export BENCH_FILTER="${1#--filter=}"
+      ;;
+    --filter)
+      export BENCH_FILTER="$2"
+      shift
+      ;;
+    --cxx=*)
+      compilers=("${compilers[@]}" "${1#--cxx=}")
+      ;;
+    --cxx)
+      compilers=("${compilers[@]}" "$2")
+      shift
+      ;;
     -O*)
       opt="$1"
       ;;
@@ -104,21 +126,38 @@ if [[ -z "$realtime" ]]; then
   echo "Add '$USER  -  rtprio  10' to /etc/security/limits.conf for less noisy benchmark results"
 fi
 
+((${#compilers[@]} == 0)) && compilers=("$CXX")
+outputs=()
+
 for arch in ${arch_list}; do
   if [[ $arch == "generic" ]]; then
-    CXXFLAGS="$cxxflags -lmvec"
+    CXXFLAGS="$cxxflags -pthread -lmvec"
   else
-    CXXFLAGS="$cxxflags -march=$arch -lmvec"
+    CXXFLAGS="$cxxflags -march=$arch -pthread -lmvec"
   fi
 
-  echo $CCACHE $CXX $CXXFLAGS "${flags[@]}" "$dir/${name}.cpp" -o "$dir/bin/$name-$arch"
-  $CCACHE $CXX $CXXFLAGS "${flags[@]}" "$dir/${name}.cpp" -o "$dir/bin/$name-$arch"
-  if (($? == 0)); then
-    echo "-march=$arch $flags:"
-    "$dir/benchmark-mode.sh" on
-    $realtime "$dir/bin/$name-$arch"
-    "$dir/benchmark-mode.sh" off
-  fi
+  flags_macro="-DBENCH_CXXFLAGS=\"$CXXFLAGS ${flags[*]}\""
+  for cxx in "${compilers[@]}"; do
+    binary="$dir/bin/$name-$arch"
+    if ((${#compilers[@]} > 1)); then
+      binary="$dir/bin/$name-${cxx##*/}-$arch"
+      mkdir -p "$dir/data"
+      export BENCH_OUTPUT="$dir/data/$(basename "$binary").jsonl"
+    fi
+    echo $CCACHE $cxx $CXXFLAGS "${flags[@]}" "$dir/${name}.cpp" -o "$binary"
+    $CCACHE $cxx $CXXFLAGS "${flags[@]}" "$flags_macro" "$dir/${name}.cpp" -o "$binary"
+    if (($? == 0)); then
+      echo "$cxx -march=$arch $flags:"
+      "$dir/benchmark-mode.sh" on
+      $realtime "$binary"
+      "$dir/benchmark-mode.sh" off
+      ((${#compilers[@]} > 1)) && outputs=("${outputs[@]}" "$BENCH_OUTPUT")
+    fi
+  done
 done
 
+if ((${#outputs[@]} > 1)); then
+  "$dir/compilers.py" "${outputs[@]}"
+fi
+
 # vim: tw=0 si
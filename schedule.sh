@@ -0,0 +1,217 @@
+#!/bin/bash
+
+dir="${0%/*}"
+[[ "$dir" == '.' ]] && dir="$PWD"
+
+usage() {
+  cat <<EOF
+Usage: $0 [-j <jobs>] [--cross-check=<n>] <target>...
+
+Runs bin/<target> for every <target> (e.g. sincos-default-native) and writes
+data/<target>.out and data/<target>.jsonl, like 'make <target>' does. The
+binaries must have been built already ('make all').
+
+Independent binaries run concurrently, each pinned to its own physical core.
+The SMT siblings of these cores, their neighboring cores and the core of CPU 0
+are left idle. Benchmark mode is enabled once for the whole batch.
+
+Options:
+  -j <jobs>          run at most <jobs> binaries at the same time (default: one
+                     per usable core)
+  --cross-check=<n>  afterwards re-run <n> randomly chosen table rows serially
+                     and compare them against the parallel results (default: 4)
+EOF
+}
+
+max_jobs=0
+cross_check=4
+targets=()
+while (($# > 0)); do
+  case "$1" in
+    -h|--help)
+      usage
+      exit 0
+      ;;
+    -j)
+      max_jobs="$2"
+      shift
+      ;;
+    -j*)
+      max_jobs="${1#-j}"
+      ;;
+    --cross-check=*)
+      cross_check="${1#--cross-check=}"
+      ;;
+    *)
+      if [[ ! -x "$dir/bin/$1" ]]; then
+        echo "ERROR: '$dir/bin/$1' does not exist. Call 'make bin/$1' first."
+        exit 1
+      fi
+      targets=("${targets[@]}" "$1")
+      ;;
+  esac
+  shift
+done
+
+if ((${#targets[@]} == 0)); then
+  usage
+  exit 1
+fi
+
+# One CPU per physical core, ordered by CPU number. The first CPU of each
+# thread_siblings_list represents the core.
+cores=()
+declare -A seen_core
+for cpu in $(ls -d /sys/devices/system/cpu/cpu[0-9]* | sort -V); do
+  [[ -r "$cpu/online" && "$(<$cpu/online)" == 0 ]] && continue
+  siblings="$(<$cpu/topology/thread_siblings_list)"
+  [[ -n "${seen_core[$siblings]}" ]] && continue
+  seen_core[$siblings]=1
+  cores=("${cores[@]}" "${siblings%%[,-]*}")
+done
+
+# Skip the core of CPU 0 (interrupts and housekeeping) and every other core
+# after it, so that no two benchmarks run on neighboring cores.
+slots=()
+for ((i = 1; i < ${#cores[@]}; i += 2)); do
+  slots=("${slots[@]}" "${cores[$i]}")
+done
+((${#slots[@]} == 0)) && slots=("${cores[0]}")
+if ((max_jobs > 0 && max_jobs < ${#slots[@]})); then
+  slots=("${slots[@]:0:$max_jobs}")
+fi
+echo "running ${#targets[@]} benchmarks on CPUs ${slots[*]}"
+
+realtime="chrt --fifo 10"
+$realtime true 2>/dev/null || realtime=
+
+if [[ -z "$realtime" ]]; then
+  echo "Add '$USER  -  rtprio  10' to /etc/security/limits.conf for less noisy benchmark results"
+fi
+
+mkdir -p "$dir/data"
+"$dir/benchmark-mode.sh" on
+trap '"$dir/benchmark-mode.sh" off' EXIT
+trap 'kill $(jobs -p) 2>/dev/null; exit 130' INT TERM
+
+declare -A running_pid running_target
+failed=0
+
+# Waits for the benchmark on slot $1 to exit (blocking) and reports its status.
+reap() {
+  local cpu=$1 status
+  wait ${running_pid[$cpu]}
+  status=$?
+  if ((status == 0)); then
+    echo "[cpu $cpu] ${running_target[$cpu]} done"
+  else
+    echo "[cpu $cpu] ${running_target[$cpu]} FAILED with exit status $status"
+    failed=1
+  fi
+  running_pid[$cpu]=
+}
+
+# Waits until one of the slots is free and sets $free_cpu to it.
+wait_for_slot() {
+  while true; do
+    for cpu in "${slots[@]}"; do
+      pid="${running_pid[$cpu]}"
+      if [[ -z "$pid" ]]; then
+        free_cpu=$cpu
+        return
+      elif ! kill -0 $pid 2>/dev/null; then
+        reap $cpu
+        free_cpu=$cpu
+        return
+      fi
+    done
+    sleep 1
+  done
+}
+
+for target in "${targets[@]}"; do
+  wait_for_slot
+  echo "[cpu $free_cpu] $target"
+  BENCH_OUTPUT="$dir/data/$target.jsonl" taskset -c $free_cpu $realtime "$dir/bin/$target" \
+    > "$dir/data/$target.out" &
+  running_pid[$free_cpu]=$!
+  running_target[$free_cpu]="$target"
+done
+for cpu in "${slots[@]}"; do
+  if [[ -n "${running_pid[$cpu]}" ]]; then
+    reap $cpu
+  fi
+done
+
+((cross_check > 0)) || exit $failed
+
+# Re-run a random sample of table rows one at a time (using BENCH_FILTER) and
+# compare against the numbers obtained while the other cores were busy.
+tmp="$(mktemp -d)"
+trap 'rm -rf "$tmp"; "$dir/benchmark-mode.sh" off' EXIT
+PYTHONPATH="$dir" python3 - "$dir/data" "$cross_check" "${targets[@]}" > "$tmp/samples" <<'EOF'
+import json, random, sys
+from resultdb import is_result
+
+def escape(s):
+    # fnmatch pattern for the literal s; ';' and '|' are BENCH_FILTER syntax
+    s = "".join("\\" + c if c in "*?[\\" else c for c in s)
+    return s.replace(";", "?").replace("|", "?")
+
+data, n, targets = sys.argv[1], int(sys.argv[2]), sys.argv[3:]
+rows = set()
+for target in targets:
+    try:
+        with open(f"{data}/{target}.jsonl") as f:
+            for line in f:
+                r = json.loads(line)
+                if is_result(r):
+                    rows.add((target, r["type"], r["width"], r["abi"], r["flags"]))
+    except (OSError, ValueError):
+        pass
+for target, type, width, abi, flags in random.sample(sorted(rows), min(n, len(rows))):
+    print(f"{target}\ttype={escape(type)};width={width};abi={escape(abi)};flags={escape(flags)}")
+EOF
+
+i=0
+while IFS=$'\t' read -r target filter; do
+  echo "cross-check: $target $filter"
+  BENCH_FILTER="$filter" BENCH_OUTPUT="$tmp/$i.jsonl" \
+    taskset -c ${slots[0]} $realtime "$dir/bin/$target" > /dev/null
+  ((++i))
+done < "$tmp/samples"
+
+PYTHONPATH="$dir" python3 - "$dir/data" "$tmp" <<'EOF' || failed=1
+import json, sys
+from resultdb import is_result
+
+data, tmp = sys.argv[1:]
+def key(r):
+    return (r["type"], r["width"], r["abi"], r["flags"], r["column"])
+
+disturbed = 0
+for i, line in enumerate(open(f"{tmp}/samples")):
+    target, bench_filter = line.rstrip("\n").split("\t")
+    parallel = {key(r): r for r in map(json.loads, open(f"{data}/{target}.jsonl"))
+                if is_result(r)}
+    for serial in map(json.loads, open(f"{tmp}/{i}.jsonl")):
+        p = parallel.get(key(serial)) if is_result(serial) else None
+        if p is None or not p["median"] or serial["median"] is None:
+            continue
+        diff = serial["median"] / p["median"] - 1
+        # disjoint confidence intervals of the median mean the difference is real
+        overlap = (p["ci_low"] is None or serial["ci_low"] is None
+                   or (p["ci_low"] <= serial["ci_high"] and serial["ci_low"] <= p["ci_high"]))
+        flag = "" if overlap else "  <-- disturbed"
+        disturbed += not overlap
+        print(f"{target:32} {serial['type']:>6} {serial['abi']:>8} {serial['flags'][:24]:24} "
+              f"{serial['column']:>10}: parallel {p['median']:8.4g}  serial {serial['median']:8.4g}"
+              f"  {diff:+7.2%}{flag}")
+if disturbed:
+    print(f"WARNING: {disturbed} cross-checked cells differ between parallel and serial runs")
+    sys.exit(1)
+EOF
+
+exit $failed
+
+# vim: tw=0 si sw=2
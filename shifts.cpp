@@ -84,7 +84,7 @@ template <int Special, class What>
 
     template <bool Latency, class T>
       [[gnu::noinline]]
-      static double
+      static Measurement
       do_benchmark()
       {
         using value_type = value_type_t<T>;
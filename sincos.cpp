@@ -22,13 +22,7 @@ template <int Special, class What>
         T a2 = T() + 4;
         T a3 = T() + 5;
         return {
-          0.25 * time_mean<5'000'000>([&] {
-            a0 = What::apply(a0);
-            a0 = What::apply(a0);
-            a0 = What::apply(a0);
-            a0 = What::apply(a0);
-            fake_read(a0);
-          }),
+          time_latency_fit<5'000'000>(a0, [](const T& x) { return What::apply(x); }),
           0.25 * time_mean<5'000'000>([&]() {
             fake_modify(a0, a1, a2, a3);
             T r0 = What::apply(a0);
@@ -5,17 +5,23 @@
 
 #include "bench.h"
 
-alignas(64) char mem[64 * 64] = {};
+// per thread, for the scaling mode
+alignas(64) thread_local char mem[64 * 64] = {};
+
+// the misalignment sweep: 16 consecutive stores of V (at most 2048 bytes) at an
+// offset < 64, i.e. up to 16 * 2048 + 63 bytes, or one per page starting at
+// most 32 bytes before the second page, i.e. up to 16 pages + 2048 bytes
+alignas(4096) thread_local char pages[17 * 4096] = {};
 
 template <typename T>
   static T value = {};
 
 template <typename T>
   inline void
-  store(T& x, size_t offset = 0)
+  store(T& x, size_t offset = 0, char* base = mem)
   {
     using Mem = value_type_t<T>;
-    Mem* ptr = reinterpret_cast<Mem*>(mem + offset);
+    Mem* ptr = reinterpret_cast<Mem*>(base + offset);
     fake_modify(x);
 #if USE_STD_SIMD
     if constexpr (std::is_simd_v<T>)
@@ -24,11 +30,48 @@ template <typename T>
     if constexpr (stdx::is_simd_v<T>)
       x.copy_to(ptr, stdx::element_aligned);
 #endif
-    else if constexpr (std::is_arithmetic_v<T>)
-      ptr[0] = x;
     else
+      // the misalignment sweep also stores at offsets that are not a multiple
+      // of alignof(T)
       std::memcpy(ptr, &x, sizeof(x));
-    asm(""::"m"(*mem));
+    asm(""::"m"(*base));
+  }
+
+/**
+ * 16 stores at \p base + k * Stride. Not a member of Benchmark, so that all
+ * columns and tables of the misalignment sweep share it.
+ */
+template <class V, size_t Stride>
+  [[gnu::noinline]] Measurement
+  store_throughput(char* base)
+  {
+    // element_aligned requires an address aligned to the element type: simd
+    // skips the offsets in between
+    if constexpr (requires { typename V::abi_type; })
+      if (reinterpret_cast<std::uintptr_t>(base) % alignof(value_type_t<V>) != 0)
+        return Measurement(std::numeric_limits<double>::quiet_NaN());
+    return 0.0625 * time_mean2<400'000>([base](auto& need_more) {
+                      V obj = {};
+                      while (need_more)
+                        {
+                          store<V>(obj, 0 * Stride, base);
+                          store<V>(obj, 1 * Stride, base);
+                          store<V>(obj, 2 * Stride, base);
+                          store<V>(obj, 3 * Stride, base);
+                          store<V>(obj, 4 * Stride, base);
+                          store<V>(obj, 5 * Stride, base);
+                          store<V>(obj, 6 * Stride, base);
+                          store<V>(obj, 7 * Stride, base);
+                          store<V>(obj, 8 * Stride, base);
+                          store<V>(obj, 9 * Stride, base);
+                          store<V>(obj, 10 * Stride, base);
+                          store<V>(obj, 11 * Stride, base);
+                          store<V>(obj, 12 * Stride, base);
+                          store<V>(obj, 13 * Stride, base);
+                          store<V>(obj, 14 * Stride, base);
+                          store<V>(obj, 15 * Stride, base);
+                        }
+                    });
   }
 
 template <int Special>
@@ -67,6 +110,46 @@ template <int Special>
       }
   };
 
+/**
+ * The misalignment sweep: every column stores 16 consecutive objects starting
+ * at the byte offset of the column (Misaligned), or 16 objects crossing a page
+ * boundary each (PageSplit).
+ */
+template <int Special, class Position>
+  struct Benchmark<Special, Position>
+  {
+    static constexpr auto info = Position::info;
+
+    template <class V>
+      static Times<info.size()>
+      run()
+      {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+          if constexpr (Position::page_split)
+            return Times<info.size()>(
+                     store_throughput<V, 4096>(pages + 4096 + Position::offsets[Is])...);
+          else
+            return Times<info.size()>(
+                     store_throughput<V, sizeof(V)>(pages + Position::offsets[Is])...);
+        }(std::make_index_sequence<info.size()>());
+      }
+  };
+
+template <class T>
+  void
+  bench_misaligned()
+  {
+    bench_all<T, Misaligned<0>>();
+    bench_all<T, Misaligned<8>>();
+    bench_all<T, Misaligned<16>>();
+    bench_all<T, Misaligned<24>>();
+    bench_all<T, Misaligned<32>>();
+    bench_all<T, Misaligned<40>>();
+    bench_all<T, Misaligned<48>>();
+    bench_all<T, Misaligned<56>>();
+    bench_all<T, PageSplit>();
+  }
+
 int
 main()
 {
@@ -76,4 +159,11 @@ main()
   bench_all<long long>();
   bench_all<float>();
   bench_all<double>();
+
+  bench_misaligned<char>();
+  bench_misaligned<short>();
+  bench_misaligned<int>();
+  bench_misaligned<long long>();
+  bench_misaligned<float>();
+  bench_misaligned<double>();
 }
@@ -0,0 +1,298 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/* Copyright © 2026      GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ *                       Matthias Kretz <m.kretz@gsi.de>
+ */
+
+#include "bench.h"
+#include <typeinfo>
+
+constexpr size_t KiB = 1024;
+constexpr size_t MiB = 1024 * KiB;
+constexpr size_t GiB = 1024 * MiB;
+
+/**
+ * The buffer all working sets live in (per thread): the source in the first
+ * half of the working set, the destination in the second half. Store writes a
+ * whole working set starting at the destination, so that the source survives
+ * it; hence 1.5 times the largest working set.
+ */
+char*
+stream_buffer()
+{ return thread_buffer(GiB + GiB / 2); }
+
+/**
+ * Fills the \p bytes at \p src with the source of the transform columns: about
+ * half of the elements are non-zero, without a regular pattern. Skipped if this
+ * thread already filled them for an earlier row.
+ */
+template <class T>
+  void
+  fill_source(char* src, size_t bytes)
+  {
+    static thread_local struct
+    {
+      const char* src = nullptr;
+      size_t bytes = 0;
+      const std::type_info* type = nullptr;
+    } filled;
+    // the fill of fewer bytes is a prefix of the fill of more
+    if (filled.src == src and filled.bytes >= bytes and filled.type == &typeid(T))
+      return;
+    T* const input = reinterpret_cast<T*>(src);
+    for (size_t k = 0; k < bytes / sizeof(T); ++k)
+      input[k] = T((std::uint32_t(k) * 0x9e3779b1u >> 16) & 1);
+    filled = {src, bytes, &typeid(T)};
+  }
+
+template <size_t Bytes>
+  struct WorkingSet
+  { static constexpr size_t bytes = Bytes; };
+
+struct WS4K : WorkingSet<4 * KiB>
+{ static constexpr char name[] = "   4 KiB"; };
+
+struct WS16K : WorkingSet<16 * KiB>
+{ static constexpr char name[] = "  16 KiB"; };
+
+struct WS64K : WorkingSet<64 * KiB>
+{ static constexpr char name[] = "  64 KiB"; };
+
+struct WS256K : WorkingSet<256 * KiB>
+{ static constexpr char name[] = " 256 KiB"; };
+
+struct WS1M : WorkingSet<1 * MiB>
+{ static constexpr char name[] = "   1 MiB"; };
+
+struct WS4M : WorkingSet<4 * MiB>
+{ static constexpr char name[] = "   4 MiB"; };
+
+struct WS16M : WorkingSet<16 * MiB>
+{ static constexpr char name[] = "  16 MiB"; };
+
+struct WS64M : WorkingSet<64 * MiB>
+{ static constexpr char name[] = "  64 MiB"; };
+
+struct WS256M : WorkingSet<256 * MiB>
+{ static constexpr char name[] = " 256 MiB"; };
+
+struct WS1G : WorkingSet<1 * GiB>
+{ static constexpr char name[] = "   1 GiB"; };
+
+struct Temporal
+{
+  static constexpr char name[] = "   temporal";
+  static constexpr bool nontemporal = false;
+};
+
+struct NonTemporal
+{
+  static constexpr char name[] = "nontemporal";
+  static constexpr bool nontemporal = true;
+};
+
+constexpr auto aligned
+#if USE_STD_SIMD
+  = std::simd_flag_aligned;
+#else
+  = stdx::vector_aligned;
+#endif
+
+template <class V>
+  [[gnu::always_inline]] inline V
+  load(const char* ptr)
+  {
+    if constexpr (vec_builtin<V>)
+      return *reinterpret_cast<const V*>(ptr);
+    else
+      return V(reinterpret_cast<const value_type_t<V>*>(ptr), aligned);
+  }
+
+/**
+ * Stores \p x to \p ptr, bypassing the caches if Stores::nontemporal.
+ */
+template <class Stores, class V>
+  [[gnu::always_inline]] inline void
+  store(const V& x, char* ptr)
+  {
+    if constexpr (Stores::nontemporal)
+      {
+        // in chunks of the widest streaming store that divides sizeof(V)
+        const char* from = reinterpret_cast<const char*>(&x);
+#ifdef __AVX512F__
+        if constexpr (sizeof(V) % 64 == 0)
+          for (size_t k = 0; k < sizeof(V); k += 64)
+            {
+              __m512i chunk;
+              std::memcpy(&chunk, from + k, 64);
+              _mm512_stream_si512(reinterpret_cast<__m512i*>(ptr + k), chunk);
+            }
+        else
+#endif
+#ifdef __AVX__
+        if constexpr (sizeof(V) % 32 == 0)
+          for (size_t k = 0; k < sizeof(V); k += 32)
+            {
+              __m256i chunk;
+              std::memcpy(&chunk, from + k, 32);
+              _mm256_stream_si256(reinterpret_cast<__m256i*>(ptr + k), chunk);
+            }
+        else
+#endif
+        if constexpr (sizeof(V) % 16 == 0)
+          for (size_t k = 0; k < sizeof(V); k += 16)
+            {
+              __m128i chunk;
+              std::memcpy(&chunk, from + k, 16);
+              _mm_stream_si128(reinterpret_cast<__m128i*>(ptr + k), chunk);
+            }
+        else
+          for (size_t k = 0; k < sizeof(V); k += 4)
+            {
+              int chunk;
+              std::memcpy(&chunk, from + k, 4);
+              _mm_stream_si32(reinterpret_cast<int*>(ptr + k), chunk);
+            }
+      }
+    else if constexpr (vec_builtin<V> or std::is_arithmetic_v<V>)
+      *reinterpret_cast<V*>(ptr) = x;
+    else
+      x.copy_to(reinterpret_cast<value_type_t<V>*>(ptr), aligned);
+  }
+
+/**
+ * Stores the non-zero elements of \p x to \p ptr. There are no masked
+ * non-temporal stores, so with Stores::nontemporal all rows load, blend and
+ * store the old value. Otherwise the vector builtin reference stores element by
+ * element and simd uses a masked store.
+ */
+template <class Stores, class V>
+  [[gnu::always_inline]] inline void
+  masked_store(const V& x, char* ptr)
+  {
+    if constexpr (vec_builtin<V> and Stores::nontemporal)
+      store<Stores>(x != V() ? x : load<V>(ptr), ptr);
+    else if constexpr (vec_builtin<V>)
+      {
+        for (int i = 0; i < size_v<V>; ++i)
+          if (x[i] != 0)
+            store<Stores>(x[i], ptr + i * sizeof(x[i]));
+      }
+    else if constexpr (Stores::nontemporal)
+      {
+        V out = load<V>(ptr);
+#if USE_STD_SIMD
+        out = std::simd_select(x != V(), x, out);
+#else
+        where(x != V(), out) = x;
+#endif
+        store<Stores>(out, ptr);
+      }
+    else
+#if USE_STD_SIMD
+      x.copy_to(reinterpret_cast<value_type_t<V>*>(ptr), x != V(), aligned);
+#else
+      where(x != V(), x).copy_to(reinterpret_cast<value_type_t<V>*>(ptr), aligned);
+#endif
+  }
+
+template <int Special, class WS, class Stores>
+  struct Benchmark<Special, WS, Stores>
+  {
+    static constexpr Info<3> info = {"Store", "Masked Transform", "Copy/Scale"};
+
+    // Store only writes, the others read a source and write a destination; the
+    // non-temporal Masked Transform also reads the destination
+    static constexpr std::array<double, 3> traffic = {1, Stores::nontemporal ? 3 : 2, 2};
+
+    // vectors per iteration, to amortize the loop overhead
+    static constexpr size_t unroll = 8;
+
+    // the vector builtins are the reference; every column needs at least one
+    // unrolled step in half of the working set
+    template <typename T>
+      static constexpr bool accept = size_v<T> > 1 and WS::bytes / 2 >= unroll * sizeof(T);
+
+    template <class V>
+      static Times<3>
+      run()
+      {
+        using T = value_type_t<V>;
+        constexpr size_t bytes = WS::bytes;
+        static_assert(bytes <= GiB and std::has_single_bit(bytes));
+        char* const src = stream_buffer();
+        char* const dst = src + bytes / 2;
+        fill_source<T>(src, bytes / 2);
+
+        // every column walks the whole working set, also across batches, in
+        // steps of `unroll` vectors
+        size_t offset = 0;
+        auto&& unrolled = [](auto&& f) [[gnu::always_inline]] {
+          [&]<size_t... Is>(std::index_sequence<Is...>) [[gnu::always_inline]] {
+            (f(Is * sizeof(V)), ...);
+          }(std::make_index_sequence<unroll>());
+        };
+        const Measurement store_time = 1. / unroll * time_mean2<100'000>([&](auto& need_more) {
+          V x = V();
+          fake_modify(x);
+          while (need_more)
+            {
+              unrolled([&](size_t i) { store<Stores>(x, dst + offset + i); });
+              offset = (offset + unroll * sizeof(V)) & (bytes - 1);
+            }
+        });
+
+        offset = 0;
+        return {
+          store_time,
+          1. / unroll * time_mean2<100'000>([&](auto& need_more) {
+            while (need_more)
+              {
+                unrolled([&](size_t i) {
+                  masked_store<Stores>(load<V>(src + offset + i), dst + offset + i);
+                });
+                offset = (offset + unroll * sizeof(V)) & (bytes / 2 - 1);
+              }
+          }),
+          1. / unroll * time_mean2<100'000>([&](auto& need_more) {
+            while (need_more)
+              {
+                unrolled([&](size_t i) {
+                  store<Stores>(V(load<V>(src + offset + i) * T(3)), dst + offset + i);
+                });
+                offset = (offset + unroll * sizeof(V)) & (bytes / 2 - 1);
+              }
+          })
+        };
+      }
+  };
+
+template <class T, class WS>
+  void
+  bench_stores()
+  {
+    bench_all<T, WS, Temporal>();
+    bench_all<T, WS, NonTemporal>();
+  }
+
+template <class T>
+  void
+  bench_working_sets()
+  {
+    bench_stores<T, WS4K>();
+    bench_stores<T, WS16K>();
+    bench_stores<T, WS64K>();
+    bench_stores<T, WS256K>();
+    bench_stores<T, WS1M>();
+    bench_stores<T, WS4M>();
+    bench_stores<T, WS16M>();
+    bench_stores<T, WS64M>();
+    bench_stores<T, WS256M>();
+    bench_stores<T, WS1G>();
+  }
+
+int
+main()
+{
+  bench_working_sets<float>();
+  bench_working_sets<double>();
+}